@@ -1,10 +1,218 @@
 #include<bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 using namespace std;
 
 const string DATA_FILE = "campus_data.txt";
 const string BACKUP_FILE = "campus_backup.txt";
+const string SNAPSHOT_FILE = "campus_backup.bin"; // Binary twin of BACKUP_FILE
+const string CH_FILE = "campus_backup.ch"; // Persisted contraction hierarchy
+const string JOURNAL_FILE = "campus_backup.jnl"; // Mutations since SNAPSHOT_FILE
 const string ADMIN_FILE = "admin.txt";
 
+// Routing statistics. Counters and scoped timers are kept per thread (single
+// writer, relaxed atomics) and summed on demand. Build with -DENABLE_STATS=0
+// to compile every STAT_* macro to nothing.
+#ifndef ENABLE_STATS
+#define ENABLE_STATS 1
+#endif
+
+class RoutingStats {
+public:
+    enum Counter {
+        FindPathCalls, OneToManySearches, HeapPushes, HeapPops, StalePops, Relaxations, SettledNodes,
+        WeightRebuilds, WeightNodeUpdates, PlanRouteCalls, PlanRouteSteps, JournalRecords, JournalSyncs,
+        RouteImprovementMoves, TreeCacheHits, TreeCacheMisses, OverlayRegionUpdates, CounterCount
+    };
+    enum Timer {
+        DailyRoutes, UpdateCleanliness, PrioritySelection, RoutePlanning,
+        CsvLoad, CsvSave, SnapshotLoad, SnapshotSave, JournalCompaction, CostMatrix, RouteImprovement,
+        OverlayCustomization, TimerCount
+    };
+
+    struct Totals {
+        uint64_t counters[CounterCount] = {};
+        uint64_t timerNs[TimerCount] = {};
+        uint64_t timerCalls[TimerCount] = {};
+    };
+
+    static const char* counterName(int c) {
+        static const char* names[CounterCount] = {
+            "findPathCalls", "oneToManySearches", "heapPushes", "heapPops", "stalePops", "relaxations",
+            "settledNodes", "weightRebuilds", "weightNodeUpdates", "planRouteCalls", "planRouteSteps",
+            "journalRecords", "journalSyncs", "routeImprovementMoves", "treeCacheHits", "treeCacheMisses",
+            "overlayRegionUpdates"
+        };
+        return names[c];
+    }
+
+    static const char* timerName(int t) {
+        static const char* names[TimerCount] = {
+            "dailyRoutes", "updateCleanliness", "prioritySelection", "routePlanning",
+            "csvLoad", "csvSave", "snapshotLoad", "snapshotSave", "journalCompaction", "costMatrix",
+            "routeImprovement", "overlayCustomization"
+        };
+        return names[t];
+    }
+
+    static void add(Counter c, uint64_t n) { bump(local().counters[c], n); }
+
+    static void addTime(Timer t, uint64_t ns) {
+        Block& block = local();
+        bump(block.timerNs[t], ns);
+        bump(block.timerCalls[t], 1);
+    }
+
+    static Totals snapshot() {
+        lock_guard<mutex> guard(registryLock());
+        Totals totals = retired();
+        for (Block* block : registry()) block->addTo(totals);
+        return totals;
+    }
+
+    static void reset() {
+        lock_guard<mutex> guard(registryLock());
+        retired() = Totals();
+        for (Block* block : registry()) block->clear();
+    }
+
+    // Difference between two snapshots, e.g. the work done during one day
+    static Totals difference(const Totals& after, const Totals& before) {
+        Totals d;
+        for (int c = 0; c < CounterCount; c++) d.counters[c] = after.counters[c] - before.counters[c];
+        for (int t = 0; t < TimerCount; t++) {
+            d.timerNs[t] = after.timerNs[t] - before.timerNs[t];
+            d.timerCalls[t] = after.timerCalls[t] - before.timerCalls[t];
+        }
+        return d;
+    }
+
+    static void print(const Totals& totals) {
+        cout << "\n=== Routing Statistics ===\n";
+        for (int c = 0; c < CounterCount; c++) {
+            cout << setw(30) << left << counterName(c) << setw(16) << right << totals.counters[c] << "\n";
+        }
+        cout << string(70, '-') << "\n";
+        cout << setw(30) << left << "Timer" << setw(16) << right << "Calls" << setw(20) << right << "Total ms\n";
+        for (int t = 0; t < TimerCount; t++) {
+            cout << setw(30) << left << timerName(t) << setw(16) << right << totals.timerCalls[t]
+                 << setw(19) << right << fixed << setprecision(3) << totals.timerNs[t] / 1e6 << "\n";
+        }
+    }
+
+    static void writeJson(ostream& out, const Totals& totals) {
+        out << "{";
+        for (int c = 0; c < CounterCount; c++) out << "\"" << counterName(c) << "\":" << totals.counters[c] << ",";
+        for (int t = 0; t < TimerCount; t++) {
+            out << "\"" << timerName(t) << "Calls\":" << totals.timerCalls[t] << ","
+                << "\"" << timerName(t) << "Ns\":" << totals.timerNs[t] << (t + 1 < TimerCount ? "," : "");
+        }
+        out << "}\n";
+    }
+
+    // CSV with a leading label column (e.g. the simulation day)
+    static void writeCsvHeader(ostream& out) {
+        out << "label";
+        for (int c = 0; c < CounterCount; c++) out << "," << counterName(c);
+        for (int t = 0; t < TimerCount; t++) out << "," << timerName(t) << "Calls," << timerName(t) << "Ns";
+        out << "\n";
+    }
+
+    static void writeCsvRow(ostream& out, const string& label, const Totals& totals) {
+        out << label;
+        for (int c = 0; c < CounterCount; c++) out << "," << totals.counters[c];
+        for (int t = 0; t < TimerCount; t++) out << "," << totals.timerCalls[t] << "," << totals.timerNs[t];
+        out << "\n";
+    }
+
+private:
+    struct Block {
+        atomic<uint64_t> counters[CounterCount] = {};
+        atomic<uint64_t> timerNs[TimerCount] = {};
+        atomic<uint64_t> timerCalls[TimerCount] = {};
+
+        void addTo(Totals& totals) const {
+            for (int c = 0; c < CounterCount; c++) totals.counters[c] += counters[c].load(memory_order_relaxed);
+            for (int t = 0; t < TimerCount; t++) {
+                totals.timerNs[t] += timerNs[t].load(memory_order_relaxed);
+                totals.timerCalls[t] += timerCalls[t].load(memory_order_relaxed);
+            }
+        }
+
+        void clear() {
+            for (auto& c : counters) c.store(0, memory_order_relaxed);
+            for (auto& t : timerNs) t.store(0, memory_order_relaxed);
+            for (auto& t : timerCalls) t.store(0, memory_order_relaxed);
+        }
+    };
+
+    // Registers the calling thread's block, and folds it into retired() on exit
+    struct LocalBlock {
+        Block block;
+        LocalBlock() {
+            lock_guard<mutex> guard(registryLock());
+            registry().push_back(&block);
+        }
+        ~LocalBlock() {
+            lock_guard<mutex> guard(registryLock());
+            block.addTo(retired());
+            registry().erase(find(registry().begin(), registry().end(), &block));
+        }
+    };
+
+    // Only the owning thread writes, so a relaxed load/store pair is enough
+    // (reset() may race with it and lose an in-flight increment)
+    static void bump(atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+
+    static Block& local() {
+        static thread_local LocalBlock block;
+        return block.block;
+    }
+    static mutex& registryLock() {
+        static mutex lock;
+        return lock;
+    }
+    static vector<Block*>& registry() {
+        static vector<Block*> blocks;
+        return blocks;
+    }
+    static Totals& retired() {
+        static Totals totals;
+        return totals;
+    }
+};
+
+// Adds the lifetime of a scope to one RoutingStats timer
+class ScopedStatTimer {
+private:
+    RoutingStats::Timer timer;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedStatTimer(RoutingStats::Timer t) : timer(t), start(chrono::steady_clock::now()) {}
+    ~ScopedStatTimer() {
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        RoutingStats::addTime(timer, elapsed.count());
+    }
+};
+
+#if ENABLE_STATS
+#define STAT_ADD(counter, n) RoutingStats::add(RoutingStats::counter, (n))
+#define STAT_CONCAT_INNER(a, b) a##b
+#define STAT_CONCAT(a, b) STAT_CONCAT_INNER(a, b)
+#define STAT_TIMER(timer) ScopedStatTimer STAT_CONCAT(statTimer, __LINE__)(RoutingStats::timer)
+#else
+#define STAT_ADD(counter, n) ((void)sizeof(n))
+#define STAT_TIMER(timer) ((void)0)
+#endif
+
 // Location class -> Informations of every Location
 class Location {
 public:
@@ -29,39 +237,671 @@ public:
     double distance;
     double travelTime;
     double difficulty;  // Factor representing road condition
+    bool closed = false; // Temporarily out of service; kept by the journal only
 
     Path(int from, int to, double distance, double travelTime = 1.0, double difficulty = 1.0)
         : from(from), to(to), distance(distance), travelTime(travelTime), difficulty(difficulty) {}
 };
 
+// CopyOnWrite -> value shared by copies of its holder until one of them edits
+// it; the editor then gets a private copy. Holders must all live on one thread
+// (CampusServer copies and frees its published campuses on the writer thread).
+template<class T>
+class CopyOnWrite {
+private:
+    shared_ptr<T> value = make_shared<T>();
+
+public:
+    const T& operator*() const { return *value; }
+    const T* operator->() const { return value.get(); }
+
+    T& edit() {
+        if (value.use_count() > 1) value = make_shared<T>(*value);
+        return *value;
+    }
+};
+
+// GraphColumn -> read-only array whose elements live either in a vector shared
+// by the copies of the column or inside a mapped snapshot file, which the
+// shared handle keeps mapped. set() copies the elements first unless this
+// column is their only user, so copies of a graph share what they do not edit.
+template<class T>
+class GraphColumn {
+private:
+    shared_ptr<vector<T>> storage;
+    shared_ptr<const void> mapping;
+    const T* items = nullptr;
+    size_t count = 0;
+
+public:
+    void assign(vector<T> values) {
+        storage = make_shared<vector<T>>(move(values));
+        mapping.reset();
+        items = storage->data();
+        count = storage->size();
+    }
+
+    void view(const T* mapped, size_t n, shared_ptr<const void> owner) {
+        storage.reset();
+        mapping = move(owner);
+        items = mapped;
+        count = n;
+    }
+
+    void set(size_t i, const T& value) {
+        if (!storage || storage.use_count() > 1) assign(vector<T>(items, items + count));
+        (*storage)[i] = value;
+    }
+
+    const T& operator[](size_t i) const { return items[i]; }
+    const T* data() const { return items; }
+    size_t size() const { return count; }
+};
+
+// CampusGraph -> frozen compressed sparse row (CSR) view of the paths
+struct CampusGraph {
+    int nodeCount = 0;
+    GraphColumn<int> offset;         // Out-edges of u are [offset[u], offset[u + 1])
+    GraphColumn<int> source;
+    GraphColumn<int> target;
+    GraphColumn<double> distance;    // Weight columns, one entry per edge
+    GraphColumn<double> travelTime;
+    GraphColumn<double> difficulty;
+    GraphColumn<char> closed;
+    GraphColumn<int> inOffset;       // In-edges of v are inEdge[inOffset[v] .. inOffset[v + 1])
+    GraphColumn<int> inEdge;
+
+    int edgeCount() const { return target.size(); }
+};
+
+// Word-at-a-time FNV-style checksum of the snapshot and journal files
+uint64_t checksum64(const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = 0xcbf29ce484222325ULL ^ bytes;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        memcpy(&word, p + i, 8);
+        h = (h ^ word) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    for (; i < bytes; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+// CampusEvent -> one state mutation of a CampusMap, as written to the journal.
+// The meaning of the fields depends on the type:
+//   CleanLocation     ints: location id
+//   AdvanceDays       ints: days
+//   SetLocationState  ints: location id, days since cleaned; reals: cleanliness
+//   AddLocation       ints: id, importance, cleaning frequency, visit priority,
+//                     days since cleaned; reals: cleanliness; name
+//   AddPath           ints: from, to, closed; reals: distance, travel time, difficulty
+//   ChangePath        as AddPath, for an existing path
+//   RemovePath        ints: from, to
+struct CampusEvent {
+    enum Type : uint8_t { CleanLocation = 1, AdvanceDays, SetLocationState, AddLocation, AddPath, ChangePath, RemovePath };
+    Type type;
+    int32_t ints[5] = {};
+    double reals[3] = {};
+    string name;
+
+    explicit CampusEvent(Type t = CleanLocation) : type(t) {}
+};
+
+// Receives every mutation of the CampusMap it is attached to
+class CampusObserver {
+public:
+    virtual ~CampusObserver() = default;
+    virtual void record(const CampusEvent& event) = 0;
+};
+
 // CampusMap class -> manage locations and paths
 class CampusMap {
 private:
-    vector<Location> locations;
-    vector<vector<Path>> adjacencyList;
-    unordered_map<int, int> visitCounts;
+    // Location records hold the cold data (id, name); the hot fields live in
+    // the columns below and are copied back into the records on demand
+    mutable vector<Location> locations;
+    mutable bool recordsStale = false;
+    mutable CopyOnWrite<vector<vector<Path>>> adjacencyList; // Shared with copies until edited
+    mutable bool adjacencyStale = false; // A loaded snapshot builds the list on first use
+    mutable CampusGraph graph; // Rebuilt from adjacencyList when the topology changes
+    mutable uint64_t graphTopology = UINT64_MAX;
+
+    // Structure-of-arrays store, one entry per slot (slot = position in locations)
+    vector<int> slotById; // Dense id -> slot index, -1 if unused
+    vector<int> importance;
+    vector<double> cleanlinessStatus;
+    vector<int> lastCleaned;
+    vector<int> cleaningFrequency;
+    vector<int> visitPriority;
+    vector<int> visitCount;
+    vector<double> priority; // Cached dynamic priority
+
+    // Priority index: slots bucketed by priority (the bucket is monotone in the
+    // priority), each bucket an intrusive list, so a priority change is an O(1)
+    // move and the top k come from the highest buckets. Built on first use.
+    static const int PriorityBuckets = 4096;
+    static constexpr double BucketsPerPoint = 64.0; // Covers priorities 0 .. 64
+    bool priorityIndexBuilt = false;
+    vector<int> bucketHead; // First slot of each bucket, -1 if empty
+    vector<int> bucketNext, bucketPrev, bucketOfSlot;
+
+    // State epochs: bumped by every mutation so cached results can tell what changed
+    uint64_t stateEpoch = 0;
+    uint64_t topologyEpoch = 0;
+    vector<uint64_t> changedAt; // Epoch at which a slot's priority or visit count last changed
+    // Slots ordered by changedAt, most recent first (intrusive list), so a cache
+    // can visit just the slots changed since its epoch
+    int recentHead = -1;
+    vector<int> recentNext, recentPrev;
+
+public:
+    // Weight or closure change of one CSR edge, kept so cached distances can be
+    // repaired instead of recomputed. The log restarts with every topology change.
+    struct PathChange {
+        uint64_t epoch;
+        int edge;
+        double oldDistance;
+        double oldDifficulty;
+        bool wasClosed;
+    };
+
+private:
+    uint64_t pathEpoch = 0;
+    vector<PathChange> pathChanges;
+
+    // Not carried over to copies: a copied campus (e.g. a sweep scenario) is not journaled
+    struct ObserverSlot {
+        CampusObserver* observer = nullptr;
+        ObserverSlot() = default;
+        ObserverSlot(const ObserverSlot&) {}
+        ObserverSlot& operator=(const ObserverSlot&) { return *this; }
+    } observerSlot;
+
+    bool observed() const { return observerSlot.observer != nullptr; }
+    void notify(const CampusEvent& event) { observerSlot.observer->record(event); }
+
+    void notifyPath(CampusEvent::Type type, const Path& p) {
+        CampusEvent event(type);
+        event.ints[0] = p.from;
+        event.ints[1] = p.to;
+        event.ints[2] = p.closed;
+        event.reals[0] = p.distance;
+        event.reals[1] = p.travelTime;
+        event.reals[2] = p.difficulty;
+        notify(event);
+    }
+
+    void topologyChanged() {
+        ++topologyEpoch;
+        pathChanges.clear();
+    }
+
+    // Index of the first from -> to path in adjacencyList[from], -1 if none
+    int findPathIndex(int from, int to) const {
+        syncAdjacency();
+        const auto& paths = *adjacencyList;
+        if (from < 0 || from >= paths.size()) return -1;
+        for (int k = 0; k < paths[from].size(); k++) {
+            if (paths[from][k].to == to) return k;
+        }
+        return -1;
+    }
+
+    // Apply new attributes to the from -> to path in place; the CSR edge keeps
+    // its index, so only the change log tells caches what moved
+    bool changePath(int from, int to, double distance, double travelTime, double difficulty, bool closed) {
+        int k = findPathIndex(from, to);
+        if (k == -1) return false;
+        const Path& current = (*adjacencyList)[from][k];
+        if (current.distance == distance && current.travelTime == travelTime && current.difficulty == difficulty &&
+            current.closed == closed) {
+            return true;
+        }
+        Path& p = adjacencyList.edit()[from][k];
+        const CampusGraph& g = getGraph();
+        int e = g.offset[from] + k;
+        pathChanges.push_back({++pathEpoch, e, p.distance, p.difficulty, p.closed});
+        p.distance = distance;
+        p.travelTime = travelTime;
+        p.difficulty = difficulty;
+        p.closed = closed;
+        graph.distance.set(e, distance);
+        graph.travelTime.set(e, travelTime);
+        graph.difficulty.set(e, difficulty);
+        graph.closed.set(e, closed);
+        if (observed()) notifyPath(CampusEvent::ChangePath, p);
+        return true;
+    }
+
+    int slotOf(int id) const {
+        if (id < 0 || id >= slotById.size()) return -1;
+        return slotById[id];
+    }
+
+    // Copy the hot columns back into the Location records
+    void syncRecords() const {
+        if (!recordsStale) return;
+        for (int i = 0; i < locations.size(); i++) {
+            locations[i].importance = importance[i];
+            locations[i].cleanlinessStatus = cleanlinessStatus[i];
+            locations[i].lastCleaned = lastCleaned[i];
+            locations[i].cleaningFrequency = cleaningFrequency[i];
+            locations[i].visitPriority = visitPriority[i];
+        }
+        recordsStale = false;
+    }
+
+    void refreshPriority(int slot) {
+        // Calculate priority based on multiple factors
+        double timeFactorNormalized = min(1.0, static_cast<double>(lastCleaned[slot]) / cleaningFrequency[slot]);
+        // Penalize recently cleaned locations (branch-free so the sweep below vectorizes)
+        timeFactorNormalized *= (lastCleaned[slot] < cleaningFrequency[slot]) ? 0.2 : 1.0;
+
+        double updated = (importance[slot] * 0.3) + 
+                         ((100 - cleanlinessStatus[slot]) * 0.4) + 
+                         (visitPriority[slot] * 0.1) + 
+                         (timeFactorNormalized * 0.2);
+        if (updated != priority[slot]) markChanged(slot);
+        priority[slot] = updated;
+        if (priorityIndexBuilt && priorityBucket(updated) != bucketOfSlot[slot]) {
+            unlinkSlot(slot);
+            linkSlot(slot);
+        }
+    }
+
+    // Stamp slot with the current epoch and move it to the front of the recent list
+    void markChanged(int slot) {
+        changedAt[slot] = stateEpoch;
+        if (recentHead == slot) return;
+        if (recentPrev[slot] != -1) recentNext[recentPrev[slot]] = recentNext[slot];
+        if (recentNext[slot] != -1) recentPrev[recentNext[slot]] = recentPrev[slot];
+        recentPrev[slot] = -1;
+        recentNext[slot] = recentHead;
+        if (recentHead != -1) recentPrev[recentHead] = slot;
+        recentHead = slot;
+    }
+
+    // Recent list in slot order, for when every slot carries the same epoch
+    void linkAllRecent() {
+        int n = locations.size();
+        recentNext.resize(n);
+        recentPrev.resize(n);
+        for (int i = 0; i < n; i++) {
+            recentPrev[i] = i - 1;
+            recentNext[i] = i + 1 < n ? i + 1 : -1;
+        }
+        recentHead = n > 0 ? 0 : -1;
+    }
+
+    static int priorityBucket(double p) {
+        return max(0, min(PriorityBuckets - 1, static_cast<int>(p * BucketsPerPoint)));
+    }
+
+    void linkSlot(int slot) {
+        int b = priorityBucket(priority[slot]);
+        bucketOfSlot[slot] = b;
+        bucketPrev[slot] = -1;
+        bucketNext[slot] = bucketHead[b];
+        if (bucketHead[b] != -1) bucketPrev[bucketHead[b]] = slot;
+        bucketHead[b] = slot;
+    }
+
+    void unlinkSlot(int slot) {
+        int b = bucketOfSlot[slot];
+        if (bucketPrev[slot] != -1) bucketNext[bucketPrev[slot]] = bucketNext[slot];
+        else bucketHead[b] = bucketNext[slot];
+        if (bucketNext[slot] != -1) bucketPrev[bucketNext[slot]] = bucketPrev[slot];
+    }
+
+    void buildPriorityIndex() {
+        int n = locations.size();
+        bucketHead.assign(PriorityBuckets, -1);
+        bucketNext.resize(n);
+        bucketPrev.resize(n);
+        bucketOfSlot.resize(n);
+        for (int i = 0; i < n; i++) linkSlot(i);
+        priorityIndexBuilt = true;
+    }
+
+    // Whole-campus priority recomputation as a flat loop over the columns
+    void refreshAllPriorities() {
+        int n = locations.size();
+        for (int i = 0; i < n; i++) refreshPriority(i);
+    }
+
+    void clearLocations() {
+        locations.clear();
+        recordsStale = false;
+        slotById.clear();
+        importance.clear();
+        cleanlinessStatus.clear();
+        lastCleaned.clear();
+        cleaningFrequency.clear();
+        visitPriority.clear();
+        visitCount.clear();
+        priority.clear();
+        changedAt.clear();
+        recentHead = -1;
+        recentNext.clear();
+        recentPrev.clear();
+        priorityIndexBuilt = false;
+    }
+
+    // Rebuild the adjacency list deferred by loadSnapshot from the CSR arrays
+    void syncAdjacency() const {
+        if (!adjacencyStale) return;
+        adjacencyStale = false;
+        const CampusGraph& g = graph;
+        auto& paths = adjacencyList.edit();
+        paths.assign(g.nodeCount, {});
+        for (int u = 0; u < g.nodeCount; u++) {
+            paths[u].reserve(g.offset[u + 1] - g.offset[u]);
+            for (int e = g.offset[u]; e < g.offset[u + 1]; e++) {
+                Path p(u, g.target[e], g.distance[e], g.travelTime[e], g.difficulty[e]);
+                p.closed = g.closed[e];
+                paths[u].push_back(p);
+            }
+        }
+        while (!paths.empty() && paths.back().empty()) paths.pop_back();
+    }
+
+    void buildGraph() const {
+        syncAdjacency();
+        const auto& paths = *adjacencyList;
+        int n = max(paths.size(), slotById.size());
+        for (const auto& edges : paths) {
+            for (const auto& p : edges) n = max(n, p.to + 1);
+        }
+        vector<int> offset(n + 1, 0);
+        for (int u = 0; u < paths.size(); u++) offset[u + 1] = paths[u].size();
+        for (int u = 0; u < n; u++) offset[u + 1] += offset[u];
+        int m = offset[n];
+
+        vector<int> source(m), target(m), inOffset(n + 1, 0), inEdge(m);
+        vector<double> distance(m), travelTime(m), difficulty(m);
+        vector<char> closed(m);
+        for (int u = 0; u < paths.size(); u++) {
+            for (int k = 0; k < paths[u].size(); k++) {
+                const Path& p = paths[u][k];
+                int e = offset[u] + k;
+                source[e] = u;
+                target[e] = p.to;
+                distance[e] = p.distance;
+                travelTime[e] = p.travelTime;
+                difficulty[e] = p.difficulty;
+                closed[e] = p.closed;
+                inOffset[p.to + 1]++;
+            }
+        }
+        for (int v = 0; v < n; v++) inOffset[v + 1] += inOffset[v];
+        vector<int> fill(inOffset.begin(), inOffset.end() - 1);
+        for (int e = 0; e < m; e++) inEdge[fill[target[e]]++] = e;
+
+        graph.nodeCount = n;
+        graph.offset.assign(move(offset));
+        graph.source.assign(move(source));
+        graph.target.assign(move(target));
+        graph.distance.assign(move(distance));
+        graph.travelTime.assign(move(travelTime));
+        graph.difficulty.assign(move(difficulty));
+        graph.closed.assign(move(closed));
+        graph.inOffset.assign(move(inOffset));
+        graph.inEdge.assign(move(inEdge));
+        graphTopology = topologyEpoch;
+    }
+
+    // Binary snapshot: a fixed header followed by 8-byte aligned sections holding
+    // the location columns, the name string table and the ready-built CSR arrays.
+    // Loading copies the location sections but leaves the CSR arrays in the mapping.
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t locationCount;
+        uint64_t nodeCount;
+        uint64_t edgeCount;
+        uint64_t nameBytes;
+        uint64_t payloadBytes;
+        uint64_t payloadChecksum;
+        uint64_t headerChecksum; // Over all fields above
+    };
+
+    // The sections of a snapshot in file order, as (section, element count) pairs
+    template<class Visit, class Graph>
+    static void forEachSnapshotSection(const SnapshotHeader& header, Visit visit, vector<int>& ids,
+                                       vector<int>& imp, vector<int>& freq, vector<int>& vprio,
+                                       vector<int>& last, vector<int>& visits, vector<double>& clean,
+                                       vector<uint64_t>& nameOffsets, string& names, Graph& g) {
+        size_t L = header.locationCount, n = header.nodeCount, m = header.edgeCount;
+        visit(ids, L); visit(imp, L); visit(freq, L); visit(vprio, L); visit(last, L); visit(visits, L);
+        visit(clean, L); visit(nameOffsets, L + 1); visit(names, header.nameBytes);
+        visit(g.offset, n + 1); visit(g.source, m); visit(g.target, m);
+        visit(g.distance, m); visit(g.travelTime, m); visit(g.difficulty, m); visit(g.closed, m);
+        visit(g.inOffset, n + 1); visit(g.inEdge, m);
+    }
+
+    // Copy a location section out of the mapped payload
+    template<class Column>
+    static void readSection(Column& column, const char* at, size_t count, const shared_ptr<const void>&) {
+        column.resize(count);
+        if (count > 0) memcpy(&column[0], at, count * sizeof(column[0]));
+    }
+
+    // A CSR section is used where it lies; sections are 8-byte aligned in the file
+    template<class T>
+    static void readSection(GraphColumn<T>& column, const char* at, size_t count,
+                            const shared_ptr<const void>& mapping) {
+        column.view(reinterpret_cast<const T*>(at), count, mapping);
+    }
+
+    // A "# Locations" or "# Paths" block of a CSV file: bytes [begin, end)
+    struct CsvSection {
+        bool locations;
+        size_t begin, end;
+        size_t firstLine;
+        size_t lines; // Non-empty lines
+    };
+
+    static string_view trimField(string_view s) {
+        while (!s.empty() && isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+        while (!s.empty() && isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+        return s;
+    }
+
+    template<class T>
+    static bool parseField(string_view s, T& value) {
+        s = trimField(s);
+        if (s.empty()) return false;
+        auto result = from_chars(s.data(), s.data() + s.size(), value);
+        return result.ec == errc() && result.ptr == s.data() + s.size();
+    }
+
+    // Split a line on commas into at most maxFields views; returns the field count
+    // (maxFields + 1 means there were too many)
+    static int splitFields(string_view line, string_view* fields, int maxFields) {
+        int count = 0;
+        while (true) {
+            size_t comma = line.find(',');
+            if (count == maxFields) return maxFields + 1;
+            fields[count++] = line.substr(0, comma);
+            if (comma == string_view::npos) return count;
+            line.remove_prefix(comma + 1);
+        }
+    }
+
+    // Call visit(lineNumber, line) for every non-empty line of a section
+    template<class Visit>
+    static void forEachLine(string_view text, const CsvSection& section, Visit visit) {
+        size_t lineNumber = section.firstLine;
+        for (size_t at = section.begin; at < section.end; lineNumber++) {
+            size_t end = text.find('\n', at);
+            if (end == string_view::npos || end > section.end) end = section.end;
+            string_view line = trimField(text.substr(at, end - at));
+            if (!line.empty()) visit(lineNumber, line);
+            at = end + 1;
+        }
+    }
+
+    void parseLocationSection(string_view text, const CsvSection& section, vector<string>& errors) {
+        forEachLine(text, section, [&](size_t lineNumber, string_view line) {
+            string_view f[8];
+            int id, imp, freq, vprio, last, visits;
+            double clean;
+            bool ok = splitFields(line, f, 8) == 8 && parseField(f[0], id) && id >= 0 &&
+                      parseField(f[2], imp) && parseField(f[3], freq) && parseField(f[4], vprio) &&
+                      parseField(f[5], clean) && parseField(f[6], last) && parseField(f[7], visits);
+            if (!ok) {
+                errors.push_back("line " + to_string(lineNumber) + ": " + string(line));
+                return;
+            }
+            Location loc(id, string(f[1]), imp, freq, vprio, clean);
+            loc.lastCleaned = last;
+            appendLocation(loc, visits);
+        });
+    }
+
+    // Paths are read twice: once for the per-node counts, then into exactly reserved lists
+    void parsePathSections(string_view text, const vector<CsvSection>& sections, vector<string>& errors) {
+        vector<int> degree;
+        for (const auto& section : sections) {
+            if (section.locations) continue;
+            forEachLine(text, section, [&](size_t, string_view line) {
+                int from;
+                if (parseField(line.substr(0, line.find(',')), from) && from >= 0) {
+                    if (from >= degree.size()) degree.resize(from + 1, 0);
+                    degree[from]++;
+                }
+            });
+        }
+        auto& paths = adjacencyList.edit();
+        paths.assign(degree.size(), {});
+        for (int u = 0; u < degree.size(); u++) paths[u].reserve(degree[u]);
+
+        for (const auto& section : sections) {
+            if (section.locations) continue;
+            forEachLine(text, section, [&](size_t lineNumber, string_view line) {
+                string_view f[5];
+                int from, to;
+                double distance, travelTime, difficulty;
+                bool ok = splitFields(line, f, 5) == 5 && parseField(f[0], from) && from >= 0 &&
+                          parseField(f[1], to) && to >= 0 && parseField(f[2], distance) &&
+                          parseField(f[3], travelTime) && parseField(f[4], difficulty);
+                if (!ok) {
+                    errors.push_back("line " + to_string(lineNumber) + ": " + string(line));
+                    return;
+                }
+                paths[from].push_back(Path(from, to, distance, travelTime, difficulty));
+            });
+        }
+        while (!paths.empty() && paths.back().empty()) paths.pop_back();
+    }
+
+    void appendLocation(const Location& loc, int visits) {
+        int slot = locations.size();
+        locations.push_back(loc);
+        if (loc.id >= slotById.size()) slotById.resize(loc.id + 1, -1);
+        slotById[loc.id] = slot;
+        importance.push_back(loc.importance);
+        cleanlinessStatus.push_back(loc.cleanlinessStatus);
+        lastCleaned.push_back(loc.lastCleaned);
+        cleaningFrequency.push_back(loc.cleaningFrequency);
+        visitPriority.push_back(loc.visitPriority);
+        visitCount.push_back(visits);
+        priority.push_back(0.0);
+        changedAt.push_back(stateEpoch);
+        recentNext.push_back(-1);
+        recentPrev.push_back(-1);
+        markChanged(slot);
+        priorityIndexBuilt = false;
+        refreshPriority(slot);
+    }
 
 public:
     CampusMap() {}
 
     void addLocation(Location loc) {
-        locations.push_back(loc);
-        visitCounts[loc.id] = 0;
+        syncRecords();
+        ++stateEpoch;
+        topologyChanged();
+        appendLocation(loc, 0);
+        if (observed()) {
+            CampusEvent event(CampusEvent::AddLocation);
+            event.ints[0] = loc.id;
+            event.ints[1] = loc.importance;
+            event.ints[2] = loc.cleaningFrequency;
+            event.ints[3] = loc.visitPriority;
+            event.ints[4] = loc.lastCleaned;
+            event.reals[0] = loc.cleanlinessStatus;
+            event.name = loc.name;
+            notify(event);
+        }
     }
 
-    void addPath(Path p) { adjacencyList[p.from].push_back(p); }
+    void addPath(Path p) {
+        syncAdjacency();
+        topologyChanged();
+        auto& paths = adjacencyList.edit();
+        if (p.from >= paths.size()) paths.resize(p.from + 1);
+        paths[p.from].push_back(p);
+        if (observed()) notifyPath(CampusEvent::AddPath, p);
+    }
 
-    Location* getLocationById(int id) {
-        for (auto &loc : locations) {
-            if (loc.id == id) {
-                return &loc;
-            }
+    // Change the attributes of an existing from -> to path (e.g. difficulty
+    // after construction or weather); false if there is no such path
+    bool updatePath(int from, int to, double distance, double travelTime, double difficulty) {
+        int k = findPathIndex(from, to);
+        if (k == -1) return false;
+        return changePath(from, to, distance, travelTime, difficulty, (*adjacencyList)[from][k].closed);
+    }
+
+    bool updatePathDifficulty(int from, int to, double difficulty) {
+        int k = findPathIndex(from, to);
+        if (k == -1) return false;
+        const Path& p = (*adjacencyList)[from][k];
+        return changePath(from, to, p.distance, p.travelTime, difficulty, p.closed);
+    }
+
+    // Temporary closure: the path stays in the map but no route may use it
+    bool closePath(int from, int to) { return setPathClosed(from, to, true); }
+    bool reopenPath(int from, int to) { return setPathClosed(from, to, false); }
+
+    bool setPathClosed(int from, int to, bool closed) {
+        int k = findPathIndex(from, to);
+        if (k == -1) return false;
+        const Path& p = (*adjacencyList)[from][k];
+        return changePath(from, to, p.distance, p.travelTime, p.difficulty, closed);
+    }
+
+    // Permanent removal. Unlike a closure this changes the topology, so cached
+    // indexes are rebuilt rather than repaired.
+    bool removePath(int from, int to) {
+        int k = findPathIndex(from, to);
+        if (k == -1) return false;
+        topologyChanged();
+        auto& paths = adjacencyList.edit();
+        paths[from].erase(paths[from].begin() + k);
+        if (observed()) {
+            CampusEvent event(CampusEvent::RemovePath);
+            event.ints[0] = from;
+            event.ints[1] = to;
+            notify(event);
         }
-        return nullptr;
+        return true;
+    }
+
+    // Read-only: the records mirror the columns, so changes go through the mutators
+    const Location* getLocationById(int id) const {
+        int slot = slotOf(id);
+        if (slot == -1) return nullptr;
+        syncRecords();
+        return &locations[slot];
     }
 
-    Location* getLocationByName(const string& name) {
-        for (auto &loc : locations) {
+    const Location* getLocationByName(const string& name) const {
+        syncRecords();
+        for (const auto &loc : locations) {
             if (loc.name == name) {
                 return &loc;
             }
@@ -70,55 +910,160 @@ public:
     }
 
     void updateCleanlinessStatus(int days) {
-        for (auto &loc : locations) {
-            loc.lastCleaned += days;
+        STAT_TIMER(UpdateCleanliness);
+        ++stateEpoch;
+        int n = locations.size();
+        for (int i = 0; i < n; i++) {
+            lastCleaned[i] += days;
             // Cleanliness decreases over time
-            double decayRate = 100.0 / (loc.cleaningFrequency * 2); // % loss per day
-            loc.cleanlinessStatus = max(0.0, loc.cleanlinessStatus - (days * decayRate));
+            double decayRate = 100.0 / (cleaningFrequency[i] * 2); // % loss per day
+            cleanlinessStatus[i] = max(0.0, cleanlinessStatus[i] - (days * decayRate));
+        }
+        refreshAllPriorities();
+        recordsStale = true;
+        if (observed()) {
+            CampusEvent event(CampusEvent::AdvanceDays);
+            event.ints[0] = days;
+            notify(event);
         }
     }
 
     void cleanLocation(int locId) {
-        for (auto &loc : locations) {
-            if (loc.id == locId) {
-                loc.lastCleaned = 0;
-                loc.cleanlinessStatus = 100.0;
-                visitCounts[locId]++;
+        int slot = slotOf(locId);
+        if (slot == -1) return;
+        ++stateEpoch;
+        lastCleaned[slot] = 0;
+        cleanlinessStatus[slot] = 100.0;
+        visitCount[slot]++;
+        markChanged(slot);
+        refreshPriority(slot);
+        recordsStale = true;
+        if (observed()) {
+            CampusEvent event(CampusEvent::CleanLocation);
+            event.ints[0] = locId;
+            notify(event);
+        }
+    }
+
+    // Overwrite the cleaning state of one location (used to seed simulations)
+    void setLocationState(int locId, double cleanliness, int daysSinceCleaned) {
+        int slot = slotOf(locId);
+        if (slot == -1) return;
+        ++stateEpoch;
+        cleanlinessStatus[slot] = cleanliness;
+        lastCleaned[slot] = daysSinceCleaned;
+        refreshPriority(slot);
+        recordsStale = true;
+        if (observed()) {
+            CampusEvent event(CampusEvent::SetLocationState);
+            event.ints[0] = locId;
+            event.ints[1] = daysSinceCleaned;
+            event.reals[0] = cleanliness;
+            notify(event);
+        }
+    }
+
+    // Replay one journaled mutation
+    void applyEvent(const CampusEvent& e) {
+        switch (e.type) {
+            case CampusEvent::CleanLocation: cleanLocation(e.ints[0]); break;
+            case CampusEvent::AdvanceDays: updateCleanlinessStatus(e.ints[0]); break;
+            case CampusEvent::SetLocationState: setLocationState(e.ints[0], e.reals[0], e.ints[1]); break;
+            case CampusEvent::AddLocation: {
+                Location loc(e.ints[0], e.name, e.ints[1], e.ints[2], e.ints[3], e.reals[0]);
+                loc.lastCleaned = e.ints[4];
+                addLocation(loc);
                 break;
             }
+            case CampusEvent::AddPath: {
+                Path p(e.ints[0], e.ints[1], e.reals[0], e.reals[1], e.reals[2]);
+                p.closed = e.ints[2];
+                addPath(p);
+                break;
+            }
+            case CampusEvent::ChangePath:
+                changePath(e.ints[0], e.ints[1], e.reals[0], e.reals[1], e.reals[2], e.ints[2]);
+                break;
+            case CampusEvent::RemovePath: removePath(e.ints[0], e.ints[1]); break;
         }
     }
 
-    double calculateDynamicPriority(int locId) {
-        for (const auto &loc : locations) {
-            if (loc.id == locId) {
-                // Calculate priority based on multiple factors
-                double timeFactorNormalized = min(1.0, static_cast<double>(loc.lastCleaned) / loc.cleaningFrequency);
-                if (loc.lastCleaned < loc.cleaningFrequency) timeFactorNormalized *= 0.2; // Penalize recently cleaned locations
-                
-                double priority = (loc.importance * 0.3) + 
-                                 ((100 - loc.cleanlinessStatus) * 0.4) + 
-                                 (loc.visitPriority * 0.1) + 
-                                 (timeFactorNormalized * 0.2);
-                return priority;
-            }
+    // Report every later mutation to observer (nullptr to detach)
+    void setObserver(CampusObserver* observer) { observerSlot.observer = observer; }
+
+    double calculateDynamicPriority(int locId) const {
+        int slot = slotOf(locId);
+        return slot == -1 ? 0.0 : priority[slot];
+    }
+
+    // Ids of the k highest-priority locations, highest first (ties in location
+    // order). Whole buckets are gathered from the top until they hold k slots,
+    // then only those are partially selected and sorted: O(k log k + buckets).
+    vector<int> topPriorityLocations(int k) {
+        if (!priorityIndexBuilt) buildPriorityIndex();
+        k = max(0, min(k, static_cast<int>(locations.size())));
+        vector<int> slots;
+        for (int b = PriorityBuckets - 1; b >= 0 && slots.size() < k; b--) {
+            for (int slot = bucketHead[b]; slot != -1; slot = bucketNext[slot]) slots.push_back(slot);
         }
-        return 0.0;
+        auto higher = [&](int a, int b) { return priority[a] != priority[b] ? priority[a] > priority[b] : a < b; };
+        if (slots.size() > k) nth_element(slots.begin(), slots.begin() + k, slots.end(), higher);
+        slots.resize(k);
+        sort(slots.begin(), slots.end(), higher);
+        vector<int> ids(k);
+        for (int i = 0; i < k; i++) ids[i] = locations[slots[i]].id;
+        return ids;
     }
 
+    int getLocationCount() const { return locations.size(); }
+
     const vector<vector<Path>>& getAdjacencyList() const {
-        return adjacencyList;
+        syncAdjacency();
+        return *adjacencyList;
+    }
+
+    // CSR form of the current paths; searches should run on this
+    const CampusGraph& getGraph() const {
+        if (graphTopology != topologyEpoch) buildGraph();
+        return graph;
     }
 
     const vector<Location>& getLocations() const {
+        syncRecords();
         return locations;
     }
 
     int getVisitCount(int locId) const {
-        if (visitCounts.find(locId) != visitCounts.end()) {
-            return visitCounts.at(locId);
+        int slot = slotOf(locId);
+        return slot == -1 ? 0 : visitCount[slot];
+    }
+
+    uint64_t getStateEpoch() const { return stateEpoch; }
+    uint64_t getTopologyEpoch() const { return topologyEpoch; }
+    uint64_t getPathEpoch() const { return pathEpoch; }
+
+    // Path changes since the last topology change, oldest first
+    const vector<PathChange>& getPathChanges() const { return pathChanges; }
+
+    // Index of the first logged change made after epoch
+    int firstPathChangeAfter(uint64_t epoch) const {
+        return partition_point(pathChanges.begin(), pathChanges.end(),
+                               [&](const PathChange& c) { return c.epoch <= epoch; }) - pathChanges.begin();
+    }
+
+    // Visit the id of every location whose priority or visit count changed
+    // after epoch, most recent first, in time proportional to their number
+    template<class Visit>
+    void forEachChangeAfter(uint64_t epoch, Visit visit) const {
+        for (int slot = recentHead; slot != -1 && changedAt[slot] > epoch; slot = recentNext[slot]) {
+            visit(locations[slot].id);
         }
-        return 0;
+    }
+
+    // Epoch at which the priority or visit count of locId last changed
+    uint64_t getChangeEpoch(int locId) const {
+        int slot = slotOf(locId);
+        return slot == -1 ? 0 : changedAt[slot];
     }
 
     void printLocationsStatus() const {
@@ -131,323 +1076,3997 @@ public:
     
         cout << string(87, '-') << "\n";  
     
-        for (const auto &loc : locations) {
-            double priority = const_cast<CampusMap*>(this)->calculateDynamicPriority(loc.id);
-            cout << setw(30) << left << loc.name 
-                 << setw(9) << right << fixed << setprecision(2) << loc.cleanlinessStatus << " %"  
-                 << setw(13) << right << loc.lastCleaned << " days"  
-                 << setw(14) << right << fixed << setprecision(2) << priority
-                 << setw(10) << right << visitCounts.at(loc.id) << "\n";
+        for (int i = 0; i < locations.size(); i++) {
+            cout << setw(30) << left << locations[i].name 
+                 << setw(9) << right << fixed << setprecision(2) << cleanlinessStatus[i] << " %"  
+                 << setw(13) << right << lastCleaned[i] << " days"  
+                 << setw(14) << right << fixed << setprecision(2) << priority[i]
+                 << setw(10) << right << visitCount[i] << "\n";
+        }
+        cout << "\n";
+    }
+
+    // New file handling methods
+    bool saveToFile(const string& filename) const {
+        STAT_TIMER(CsvSave);
+        ofstream outFile(filename);
+        if (!outFile) {
+            cerr << "Error opening file for writing: " << filename << endl;
+            return false;
+        }
+
+        // Save locations
+        outFile << "# Locations\n";
+        for (int i = 0; i < locations.size(); i++) {
+            outFile << locations[i].id << ","
+                    << locations[i].name << ","
+                    << importance[i] << ","
+                    << cleaningFrequency[i] << ","
+                    << visitPriority[i] << ","
+                    << cleanlinessStatus[i] << ","
+                    << lastCleaned[i] << ","
+                    << visitCount[i] << "\n";
+        }
+
+        // Save paths
+        outFile << "# Paths\n";
+        syncAdjacency();
+        const auto& paths = *adjacencyList;
+        for (int from = 0; from < paths.size(); ++from) {
+            for (const auto& path : paths[from]) {
+                outFile << path.from << ","
+                        << path.to << ","
+                        << path.distance << ","
+                        << path.travelTime << ","
+                        << path.difficulty << "\n";
+            }
+        }
+
+        outFile.close();
+        return true;
+    }
+
+    // Write a binary snapshot next to the text backup. It is written to a
+    // temporary file and renamed, and checksummed so a torn copy is rejected.
+    bool saveSnapshot(const string& filename) const {
+        STAT_TIMER(SnapshotSave);
+        syncRecords();
+        const CampusGraph& g = getGraph();
+        vector<int> ids, imp = importance, freq = cleaningFrequency, vprio = visitPriority;
+        vector<int> last = lastCleaned, visits = visitCount;
+        vector<double> clean = cleanlinessStatus;
+        vector<uint64_t> nameOffsets = {0};
+        string names;
+        for (const auto& loc : locations) {
+            ids.push_back(loc.id);
+            names += loc.name;
+            nameOffsets.push_back(names.size());
+        }
+
+        SnapshotHeader header = {};
+        memcpy(header.magic, "CAMPSNAP", 8);
+        header.version = 2;
+        header.headerSize = sizeof(SnapshotHeader);
+        header.locationCount = locations.size();
+        header.nodeCount = g.nodeCount;
+        header.edgeCount = g.edgeCount();
+        header.nameBytes = names.size();
+
+        string payload;
+        forEachSnapshotSection(header, [&](const auto& section, size_t count) {
+            payload.append(reinterpret_cast<const char*>(section.data()), count * sizeof(*section.data()));
+            payload.append((8 - payload.size() % 8) % 8, '\0');
+        }, ids, imp, freq, vprio, last, visits, clean, nameOffsets, names, g);
+
+        header.payloadBytes = payload.size();
+        header.payloadChecksum = checksum64(payload.data(), payload.size());
+        header.headerChecksum = checksum64(&header, offsetof(SnapshotHeader, headerChecksum));
+
+        string tempName = filename + ".tmp";
+        ofstream outFile(tempName, ios::binary);
+        if (!outFile) {
+            cerr << "Error opening file for writing: " << tempName << endl;
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char*>(&header), sizeof header);
+        outFile.write(payload.data(), payload.size());
+        outFile.close();
+        if (!outFile || rename(tempName.c_str(), filename.c_str()) != 0) {
+            cerr << "Error writing snapshot: " << filename << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Identity of a snapshot file (its header checksum), 0 if it is not one
+    static uint64_t snapshotId(const string& filename) {
+        SnapshotHeader header;
+        ifstream inFile(filename, ios::binary);
+        if (!inFile.read(reinterpret_cast<char*>(&header), sizeof header)) return 0;
+        if (memcmp(header.magic, "CAMPSNAP", 8) != 0) return 0;
+        return header.headerChecksum;
+    }
+
+    // Map a binary snapshot. The location columns are copied out; the CSR arrays
+    // are served from the mapping, which stays open while any copy of them lives
+    // (saves replace the file by rename, so the mapped pages never change), and
+    // the adjacency list is rebuilt from them only when something needs it.
+    bool loadSnapshot(const string& filename) {
+        STAT_TIMER(SnapshotLoad);
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < sizeof(SnapshotHeader)) {
+            close(fd);
+            return false;
+        }
+        size_t fileBytes = info.st_size;
+        void* mapped = mmap(nullptr, fileBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) return false;
+        shared_ptr<const void> mapping(mapped, [fileBytes](const void* p) { munmap(const_cast<void*>(p), fileBytes); });
+        const char* base = static_cast<const char*>(mapped);
+
+        SnapshotHeader header;
+        memcpy(&header, base, sizeof header);
+        const char* payload = base + sizeof header;
+        bool valid = memcmp(header.magic, "CAMPSNAP", 8) == 0 && header.version == 2 &&
+                     header.headerSize == sizeof(SnapshotHeader) &&
+                     header.headerChecksum == checksum64(&header, offsetof(SnapshotHeader, headerChecksum)) &&
+                     header.payloadBytes == fileBytes - sizeof header &&
+                     header.payloadChecksum == checksum64(payload, header.payloadBytes);
+        if (!valid) {
+            cerr << "Snapshot " << filename << " is damaged or from another version; ignoring it.\n";
+            return false;
+        }
+
+        size_t L = header.locationCount;
+        vector<int> ids, imp, freq, vprio, last, visits;
+        vector<double> clean;
+        vector<uint64_t> nameOffsets;
+        string names;
+        CampusGraph g;
+        g.nodeCount = header.nodeCount;
+        size_t at = 0;
+        forEachSnapshotSection(header, [&](auto& section, size_t count) {
+            size_t bytes = count * sizeof(section[0]);
+            if (!valid || at > header.payloadBytes || bytes > header.payloadBytes - at) {
+                valid = false;
+                return;
+            }
+            readSection(section, payload + at, count, mapping);
+            at += bytes + (8 - bytes % 8) % 8;
+        }, ids, imp, freq, vprio, last, visits, clean, nameOffsets, names, g);
+        if (!valid || nameOffsets[L] != names.size()) return false;
+
+        clearLocations();
+        ++stateEpoch;
+        topologyChanged();
+        locations.reserve(L);
+        for (size_t i = 0; i < L; i++) {
+            Location loc(ids[i], names.substr(nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]),
+                         imp[i], freq[i], vprio[i], clean[i]);
+            loc.lastCleaned = last[i];
+            locations.push_back(loc);
+            if (ids[i] >= slotById.size()) slotById.resize(ids[i] + 1, -1);
+            slotById[ids[i]] = i;
+        }
+        importance = move(imp);
+        cleaningFrequency = move(freq);
+        visitPriority = move(vprio);
+        lastCleaned = move(last);
+        visitCount = move(visits);
+        cleanlinessStatus = move(clean);
+        priority.assign(L, 0.0);
+        changedAt.assign(L, stateEpoch);
+        linkAllRecent();
+        refreshAllPriorities();
+
+        adjacencyList = {};
+        adjacencyStale = true;
+        graph = move(g);
+        graphTopology = topologyEpoch;
+        return true;
+    }
+
+    // Streaming CSV loader. The file is mapped and parsed in place with
+    // from_chars; sections are located and their lines counted first so the
+    // columns and adjacency lists are sized exactly once. Malformed lines are
+    // counted and the first few logged instead of throwing per line.
+    bool loadFromFile(const string& filename, bool parallel = false) {
+        STAT_TIMER(CsvLoad);
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cerr << "Data file not found. Starting with new data.\n";
+            return false;
+        }
+        struct stat info;
+        size_t fileBytes = (fstat(fd, &info) == 0) ? info.st_size : 0;
+        void* mapped = fileBytes > 0 ? mmap(nullptr, fileBytes, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            cerr << "Error reading file: " << filename << endl;
+            return false;
+        }
+        if (mapped) madvise(mapped, fileBytes, MADV_SEQUENTIAL);
+        string_view text(static_cast<const char*>(mapped), fileBytes);
+
+        clearLocations();
+        adjacencyList = {};
+        adjacencyStale = false;
+        ++stateEpoch;
+        topologyChanged();
+
+        // Locate the sections and count their lines
+        vector<CsvSection> sections;
+        CsvSection* current = nullptr;
+        vector<string> errors; // Lines outside any section
+        size_t lineNumber = 0;
+        for (size_t at = 0; at < text.size();) {
+            size_t end = text.find('\n', at);
+            if (end == string_view::npos) end = text.size();
+            string_view line = trimField(text.substr(at, end - at));
+            lineNumber++;
+            if (line == "# Locations" || line == "# Paths") {
+                sections.push_back({line == "# Locations", end + 1, end + 1, lineNumber + 1, 0});
+                current = &sections.back();
+            } else if (!line.empty()) {
+                if (current) current->lines++;
+                else errors.push_back("line " + to_string(lineNumber) + ": " + string(line));
+            }
+            if (current) current->end = min(end + 1, text.size());
+            at = end + 1;
+        }
+
+        size_t locationLines = 0;
+        for (const auto& section : sections) {
+            if (section.locations) locationLines += section.lines;
+        }
+        locations.reserve(locationLines);
+        for (auto* column : {&importance, &lastCleaned, &cleaningFrequency, &visitPriority, &visitCount}) column->reserve(locationLines);
+        cleanlinessStatus.reserve(locationLines);
+        priority.reserve(locationLines);
+        changedAt.reserve(locationLines);
+
+        size_t malformed = errors.size();
+        vector<string> locationErrors, pathErrors;
+        auto parseLocations = [&] {
+            for (const auto& section : sections) {
+                if (section.locations) parseLocationSection(text, section, locationErrors);
+            }
+        };
+        auto parsePaths = [&] { parsePathSections(text, sections, pathErrors); };
+        if (parallel) {
+            thread locationThread(parseLocations);
+            parsePaths();
+            locationThread.join();
+        } else {
+            parseLocations();
+            parsePaths();
+        }
+        if (mapped) munmap(mapped, fileBytes);
+
+        malformed += locationErrors.size() + pathErrors.size();
+        errors.insert(errors.end(), locationErrors.begin(), locationErrors.end());
+        errors.insert(errors.end(), pathErrors.begin(), pathErrors.end());
+        const size_t maxLogged = 10;
+        for (size_t i = 0; i < min(errors.size(), maxLogged); i++) cerr << "Invalid format at " << errors[i] << endl;
+        if (malformed > maxLogged) cerr << "... " << (malformed - maxLogged) << " more malformed lines\n";
+        if (malformed > 0) cerr << malformed << " malformed line(s) skipped in " << filename << endl;
+
+        buildGraph();
+        return true;
+    }
+};
+
+// Append-only journal of CampusMap mutations on top of the binary snapshot.
+// Records are buffered and written with one fdatasync per group (at every day
+// boundary or every groupSize records), so durability costs O(event). When
+// the journal outgrows the snapshot it is compacted: a fresh snapshot is
+// written and the journal restarts empty. Startup loads the snapshot and
+// replays the journal written against it; a torn tail record is dropped.
+//
+// File layout: a JournalHeader naming the snapshot, then records of
+// [uint32 body bytes][body][uint64 checksum of body].
+class CampusJournal : public CampusObserver {
+private:
+    struct JournalHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t snapshotId;     // CampusMap::snapshotId of the base snapshot
+        uint64_t headerChecksum; // Over all fields above
+    };
+
+    CampusMap* campus;
+    string journalFile, snapshotFile;
+    int fd = -1;
+    string buffer;         // Encoded records not yet written
+    int buffered = 0;
+    size_t fileBytes = 0;  // Journal length on disk
+    size_t compactBytes = 1 << 20;
+    int groupSize = 512;
+
+    static void encode(const CampusEvent& event, string& out) {
+        uint32_t nameBytes = event.name.size();
+        uint32_t bodyBytes = 1 + sizeof event.ints + sizeof event.reals + sizeof nameBytes + nameBytes;
+        size_t at = out.size();
+        out.append(reinterpret_cast<const char*>(&bodyBytes), sizeof bodyBytes);
+        out.push_back(static_cast<char>(event.type));
+        out.append(reinterpret_cast<const char*>(event.ints), sizeof event.ints);
+        out.append(reinterpret_cast<const char*>(event.reals), sizeof event.reals);
+        out.append(reinterpret_cast<const char*>(&nameBytes), sizeof nameBytes);
+        out += event.name;
+        uint64_t checksum = checksum64(out.data() + at + sizeof bodyBytes, bodyBytes);
+        out.append(reinterpret_cast<const char*>(&checksum), sizeof checksum);
+    }
+
+    // Decode the record at text[at]; false on a torn or corrupt record
+    static bool decode(const string& text, size_t& at, CampusEvent& event) {
+        uint32_t bodyBytes;
+        size_t fixed = 1 + sizeof event.ints + sizeof event.reals + sizeof(uint32_t);
+        if (at + sizeof bodyBytes > text.size()) return false;
+        memcpy(&bodyBytes, text.data() + at, sizeof bodyBytes);
+        size_t body = at + sizeof bodyBytes;
+        uint64_t checksum;
+        if (bodyBytes < fixed || body + bodyBytes + sizeof checksum > text.size()) return false;
+        memcpy(&checksum, text.data() + body + bodyBytes, sizeof checksum);
+        if (checksum != checksum64(text.data() + body, bodyBytes)) return false;
+
+        uint32_t nameBytes;
+        event.type = static_cast<CampusEvent::Type>(text[body]);
+        memcpy(event.ints, text.data() + body + 1, sizeof event.ints);
+        memcpy(event.reals, text.data() + body + 1 + sizeof event.ints, sizeof event.reals);
+        memcpy(&nameBytes, text.data() + body + fixed - sizeof nameBytes, sizeof nameBytes);
+        if (fixed + nameBytes != bodyBytes) return false;
+        event.name.assign(text, body + fixed, nameBytes);
+        at = body + bodyBytes + sizeof checksum;
+        return true;
+    }
+
+    static JournalHeader makeHeader(uint64_t snapshotId) {
+        JournalHeader header = {};
+        memcpy(header.magic, "CAMPJRNL", 8);
+        header.version = 1;
+        header.headerSize = sizeof(JournalHeader);
+        header.snapshotId = snapshotId;
+        header.headerChecksum = checksum64(&header, offsetof(JournalHeader, headerChecksum));
+        return header;
+    }
+
+    static bool syncFile(const string& filename) {
+        int file = open(filename.c_str(), O_RDONLY);
+        if (file < 0) return false;
+        bool ok = fsync(file) == 0;
+        close(file);
+        return ok;
+    }
+
+    // Write a whole file and make it durable before it replaces filename
+    static bool replaceFile(const string& filename, const string& contents) {
+        string tempName = filename + ".tmp";
+        int file = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file < 0) return false;
+        bool ok = ::write(file, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size()) &&
+                  fdatasync(file) == 0;
+        close(file);
+        if (!ok || rename(tempName.c_str(), filename.c_str()) != 0) return false;
+        filesystem::path dir = filesystem::path(filename).parent_path();
+        syncFile(dir.empty() ? "." : dir.string());
+        return true;
+    }
+
+    void openForAppend() {
+        if (fd >= 0) close(fd);
+        fd = open(journalFile.c_str(), O_WRONLY | O_APPEND);
+        if (fd < 0) cerr << "Error: Could not open journal " << journalFile << endl;
+    }
+
+public:
+    CampusJournal(CampusMap* c, const string& journal = JOURNAL_FILE, const string& snapshot = SNAPSHOT_FILE)
+        : campus(c), journalFile(journal), snapshotFile(snapshot) {}
+
+    ~CampusJournal() {
+        commit();
+        campus->setObserver(nullptr);
+        if (fd >= 0) close(fd);
+    }
+
+    // Apply the journal written against the snapshot with id snapshotId.
+    // Returns the length of its valid prefix, or 0 if it is missing, damaged
+    // in the header, or belongs to another snapshot.
+    static size_t replay(CampusMap& campus, const string& filename, uint64_t snapshotId) {
+        ifstream inFile(filename, ios::binary);
+        if (!inFile || snapshotId == 0) return 0;
+        string text((istreambuf_iterator<char>(inFile)), istreambuf_iterator<char>());
+        JournalHeader header;
+        if (text.size() < sizeof header) return 0;
+        memcpy(&header, text.data(), sizeof header);
+        JournalHeader expected = makeHeader(snapshotId);
+        if (memcmp(&header, &expected, sizeof header) != 0) return 0;
+
+        size_t at = sizeof header;
+        size_t records = 0;
+        CampusEvent event;
+        while (decode(text, at, event)) {
+            campus.applyEvent(event);
+            records++;
+        }
+        if (at < text.size()) cerr << "Journal " << filename << ": dropped " << (text.size() - at) << " byte torn tail\n";
+        if (records > 0) cerr << "Replayed " << records << " journaled change(s).\n";
+        return at;
+    }
+
+    // Start recording: continue the journal after its valid prefix, or compact
+    // when there is no usable journal for the loaded snapshot
+    void start(size_t validBytes) {
+        campus->setObserver(this);
+        if (validBytes == 0 || truncate(journalFile.c_str(), validBytes) != 0) {
+            compact();
+            return;
+        }
+        fileBytes = validBytes;
+        error_code ec;
+        compactBytes = max<size_t>(1 << 20, filesystem::file_size(snapshotFile, ec));
+        openForAppend();
+    }
+
+    void record(const CampusEvent& event) override {
+        encode(event, buffer);
+        buffered++;
+        STAT_ADD(JournalRecords, 1);
+        // A new day commits the previous one as a group
+        if (event.type == CampusEvent::AdvanceDays || buffered >= groupSize) commit();
+    }
+
+    // Write the buffered records with a single fdatasync
+    void commit() {
+        if (buffer.empty()) return;
+        if (fd < 0 || ::write(fd, buffer.data(), buffer.size()) != static_cast<ssize_t>(buffer.size()) ||
+            fdatasync(fd) != 0) {
+            cerr << "Error: Could not write journal " << journalFile << endl;
+            return;
+        }
+        STAT_ADD(JournalSyncs, 1);
+        fileBytes += buffer.size();
+        buffer.clear();
+        buffered = 0;
+        if (fileBytes > compactBytes) compact();
+    }
+
+    // Fold everything into a fresh snapshot and restart the journal against it.
+    // Closures are not part of the snapshot, so they open the new journal.
+    bool compact() {
+        STAT_TIMER(JournalCompaction);
+        if (!campus->saveSnapshot(snapshotFile) || !syncFile(snapshotFile)) {
+            cerr << "Error: Compaction failed; keeping the journal\n";
+            return false;
+        }
+        JournalHeader header = makeHeader(CampusMap::snapshotId(snapshotFile));
+        string contents(reinterpret_cast<const char*>(&header), sizeof header);
+        const auto& adjList = campus->getAdjacencyList();
+        for (int u = 0; u < adjList.size(); u++) {
+            for (const auto& p : adjList[u]) {
+                if (!p.closed) continue;
+                CampusEvent event(CampusEvent::ChangePath);
+                event.ints[0] = u;
+                event.ints[1] = p.to;
+                event.ints[2] = 1;
+                event.reals[0] = p.distance;
+                event.reals[1] = p.travelTime;
+                event.reals[2] = p.difficulty;
+                encode(event, contents);
+            }
+        }
+        if (!replaceFile(journalFile, contents)) {
+            cerr << "Error: Could not reset journal " << journalFile << endl;
+            return false;
+        }
+        buffer.clear();
+        buffered = 0;
+        fileBytes = contents.size();
+        error_code ec;
+        compactBytes = max<size_t>(1 << 20, filesystem::file_size(snapshotFile, ec));
+        openForAppend();
+        return true;
+    }
+};
+
+// Priority-queue policies for the searches in ModifiedDijkstra. All share one
+// interface: reset(n) for node ids below n, push(key, node) to insert or lower
+// a key, and pop() for the minimum. pop() may return an outdated entry for the
+// lazy queues, so callers skip entries whose key is above the node's distance.
+
+// std::priority_queue with lazy deletion of outdated entries
+class LazyBinaryHeap {
+private:
+    vector<pair<double, int>> heap;
+
+public:
+    void reset(int) { heap.clear(); }
+    bool empty() const { return heap.empty(); }
+
+    void push(double key, int node) {
+        heap.push_back({key, node});
+        push_heap(heap.begin(), heap.end(), greater<>());
+    }
+
+    pair<double, int> pop() {
+        pop_heap(heap.begin(), heap.end(), greater<>());
+        pair<double, int> top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+};
+
+// Indexed D-ary heap with decrease-key; holds each node at most once
+template<int D = 4>
+class IndexedDaryHeap {
+private:
+    vector<int> heap;       // Node ids in heap order
+    vector<double> keys;    // Key of each heap position
+    vector<int> position;   // Heap position of each node, -1 if not queued
+
+    void place(int i, double key, int node) {
+        heap[i] = node;
+        keys[i] = key;
+        position[node] = i;
+    }
+
+    void siftUp(int i, double key, int node) {
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (keys[parent] <= key) break;
+            place(i, keys[parent], heap[parent]);
+            i = parent;
+        }
+        place(i, key, node);
+    }
+
+    void siftDown(int i, double key, int node) {
+        int size = heap.size();
+        while (true) {
+            int first = i * D + 1;
+            if (first >= size) break;
+            int best = first;
+            for (int c = first + 1; c < min(first + D, size); c++) {
+                if (keys[c] < keys[best]) best = c;
+            }
+            if (keys[best] >= key) break;
+            place(i, keys[best], heap[best]);
+            i = best;
+        }
+        place(i, key, node);
+    }
+
+public:
+    void reset(int n) {
+        for (int node : heap) position[node] = -1;
+        heap.clear();
+        keys.clear();
+        if (position.size() != n) position.assign(n, -1);
+    }
+
+    bool empty() const { return heap.empty(); }
+
+    void push(double key, int node) {
+        int i = position[node];
+        if (i == -1) {
+            heap.push_back(node);
+            keys.push_back(key);
+            siftUp(heap.size() - 1, key, node);
+        } else if (key < keys[i]) {
+            siftUp(i, key, node);
+        }
+    }
+
+    pair<double, int> pop() {
+        pair<double, int> top = {keys[0], heap[0]};
+        position[top.second] = -1;
+        int lastNode = heap.back();
+        double lastKey = keys.back();
+        heap.pop_back();
+        keys.pop_back();
+        if (!heap.empty()) siftDown(0, lastKey, lastNode);
+        return top;
+    }
+};
+
+// Monotone radix heap: keys pushed must not be below the last popped key, which
+// holds for Dijkstra with non-negative weights. Non-negative doubles are
+// bucketed by their IEEE bit patterns, which sort like the values.
+class RadixHeap {
+private:
+    vector<pair<double, int>> buckets[65];
+    uint64_t lastBits = 0;
+    int count = 0;
+
+    static uint64_t bitsOf(double key) {
+        uint64_t bits;
+        memcpy(&bits, &key, sizeof bits);
+        return bits;
+    }
+
+    int bucketOf(uint64_t bits) const {
+        return bits == lastBits ? 0 : 64 - __builtin_clzll(bits ^ lastBits);
+    }
+
+public:
+    void reset(int) {
+        for (auto& bucket : buckets) bucket.clear();
+        lastBits = 0;
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+
+    void push(double key, int node) {
+        buckets[bucketOf(bitsOf(key))].push_back({key, node});
+        count++;
+    }
+
+    pair<double, int> pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) i++;
+            double minKey = buckets[i][0].first;
+            for (const auto& entry : buckets[i]) minKey = min(minKey, entry.first);
+            lastBits = bitsOf(minKey);
+            for (const auto& entry : buckets[i]) buckets[bucketOf(bitsOf(entry.first))].push_back(entry);
+            buckets[i].clear();
+        }
+        pair<double, int> top = buckets[0].back();
+        buckets[0].pop_back();
+        count--;
+        return top;
+    }
+};
+
+class ModifiedDijkstra {
+    public:
+        // Algorithm used by findPath for point-to-point queries
+        enum class SearchMode { Dijkstra, Bidirectional, ALT, Regions };
+
+        // Queue policy of the Dijkstra and bidirectional searches; ALT and
+        // Regions always use the indexed heap
+        enum class QueueKind { IndexedDary, LazyBinary, Radix };
+
+        // Shortest-path tree grown from one source
+        struct SearchTree {
+            vector<double> distances;
+            vector<int> parents;
+        };
+
+    private:
+        // Per-thread search state, kept between queries so that a query
+        // allocates nothing and resets only the nodes the previous one touched
+        struct SearchWorkspace {
+            SearchTree tree;
+            vector<double> scratch; // Per-node value (ALT heuristic), -1 when unset
+            vector<char> flags;     // Per-node marker (pending target)
+            vector<int> touched;
+            vector<int> settled;    // Settle order of the last one-to-many search
+
+            void prepare(int n) {
+                if (tree.distances.size() != n) {
+                    tree.distances.assign(n, INT_MAX);
+                    tree.parents.assign(n, -1);
+                    scratch.assign(n, -1);
+                    flags.assign(n, 0);
+                } else {
+                    for (int v : touched) {
+                        tree.distances[v] = INT_MAX;
+                        tree.parents[v] = -1;
+                        scratch[v] = -1;
+                        flags[v] = 0;
+                    }
+                }
+                touched.clear();
+            }
+        };
+
+        static SearchWorkspace& workspace(int slot = 0) {
+            static thread_local SearchWorkspace spaces[2];
+            return spaces[slot];
+        }
+
+        template<class Queue>
+        static Queue& queue(int slot = 0) {
+            static thread_local Queue queues[2];
+            return queues[slot];
+        }
+
+    private:
+        const CampusMap* campus; // Only read
+        double alpha, beta, gamma, delta; // Weight factors
+        SearchMode mode = SearchMode::Dijkstra;
+        QueueKind queueKind = QueueKind::IndexedDary;
+        int settledCount = 0; // Nodes settled by the last query
+
+        // ALT landmarks: static lower-bound distances from and to each landmark
+        int landmarkCount = 4;
+        vector<int> landmarks;
+        vector<vector<double>> fromLandmark, toLandmark;
+        bool landmarksBuilt = false;
+        uint64_t landmarksTopology = 0;
+        uint64_t landmarksPathEpoch = 0;
+        vector<char> repairState; // Per-node scratch for repairDistances, all 0 between calls
+
+        // Materialized effective edge weights, indexed like the CSR edge arrays
+        vector<double> edgeWeights;
+        bool weightsBuilt = false;
+        uint64_t weightsEpoch = 0;
+        uint64_t weightsTopology = 0;
+        uint64_t weightsPathEpoch = 0;
+
+        // Shortest-path trees of earlier one-to-many searches, at most one per
+        // source, kept across days and evicted least recently used first. A
+        // source's tree is only stored on its second recent search (its first
+        // goes to treeCacheSeen), so one-off sources cost nothing to cache.
+        struct CachedTree {
+            int source;
+            uint64_t topology, stateEpoch, pathEpoch; // Campus epochs the distances hold for
+            bool complete;         // Search ran dry: every reachable node is in the tree
+            vector<int> nodes;     // Settled nodes in settle order, source first
+            vector<int> parents;
+            vector<int> edges;     // Tree edge into each node, -1 for the source
+            vector<double> distances;
+            uint64_t lastUsed;
+        };
+        int treeCacheCapacity = 16;
+        vector<CachedTree> treeCache;
+        uint64_t treeCacheClock = 0;
+        vector<int> treeCacheSeen; // Ring of recent uncached sources, 4 per tree
+        int treeCacheSeenNext = 0;
+
+        // Region overlay used by Regions mode: the nodes split into regions (one
+        // per campus or cluster), and for each region the current cost between
+        // every pair of its boundary nodes through the region itself. Rebuilt on
+        // topology changes; otherwise only regions holding a changed location or
+        // path get their costs recomputed.
+        int regionCount = 0;        // 0 picks sqrt(n) / 2 regions
+        vector<int> assignedRegions; // Region of every node from setRegions, empty when automatic
+        vector<int> regionOf;
+        vector<int> regionStart, regionNodes;     // Nodes of region r: regionNodes[regionStart[r] .. regionStart[r + 1])
+        vector<int> boundaryStart, boundaryNodes; // Boundary nodes (an edge to another region), same layout
+        vector<int> boundaryIndex;  // Position of a node among its region's boundary nodes, -1 inside
+        vector<size_t> overlayStart; // Region r's b x b cost matrix begins at overlayCost[overlayStart[r]]
+        vector<double> overlayCost;
+        vector<char> regionDirty;
+        bool overlayBuilt = false;
+        uint64_t overlayTopology = 0;
+        uint64_t overlayEpoch = 0;
+        uint64_t overlayPathEpoch = 0;
+
+        double edgeWeight(const CampusGraph& g, int e) const {
+            if (g.closed[e]) return numeric_limits<double>::infinity();
+            int to = g.target[e];
+            
+            // Calculate weighted edge cost
+            double priorityFactor = 1.0 - (campus->calculateDynamicPriority(to) / 100.0);
+            double visitFactor = 1.0 + (campus->getVisitCount(to) * delta);
+            
+            double weight = (alpha * g.distance[e]) + 
+                           (beta * g.difficulty[e]) + 
+                           (gamma * visitFactor);
+            
+            // Priority reduces the cost (more important locations are easier to include)
+            weight *= (2.0 - priorityFactor);
+            return weight;
+        }
+
+        // Bring the weight snapshot up to the campus state epoch, recomputing only
+        // the edges that enter a location whose priority or visit count changed
+        void refreshEdgeWeights() {
+            const CampusGraph& g = campus->getGraph();
+            if (!weightsBuilt || weightsTopology != campus->getTopologyEpoch()) {
+                edgeWeights.resize(g.edgeCount());
+                for (int e = 0; e < g.edgeCount(); e++) edgeWeights[e] = edgeWeight(g, e);
+                STAT_ADD(WeightRebuilds, 1);
+                weightsBuilt = true;
+                weightsTopology = campus->getTopologyEpoch();
+            } else {
+                campus->forEachChangeAfter(weightsEpoch, [&](int v) {
+                    STAT_ADD(WeightNodeUpdates, 1);
+                    for (int i = g.inOffset[v]; i < g.inOffset[v + 1]; i++) {
+                        edgeWeights[g.inEdge[i]] = edgeWeight(g, g.inEdge[i]);
+                    }
+                });
+                const auto& changes = campus->getPathChanges();
+                for (int i = campus->firstPathChangeAfter(weightsPathEpoch); i < changes.size(); i++) {
+                    edgeWeights[changes[i].edge] = edgeWeight(g, changes[i].edge);
+                }
+            }
+            weightsEpoch = campus->getStateEpoch();
+            weightsPathEpoch = campus->getPathEpoch();
+        }
+
+        // Smallest value an edge weight can take: the visit factor is at least 1
+        // and the priority multiplier (2 - priorityFactor) is at least 1
+        double staticEdgeWeight(const CampusGraph& g, int e) const {
+            if (g.closed[e]) return numeric_limits<double>::infinity();
+            return (alpha * g.distance[e]) + (beta * g.difficulty[e]) + gamma;
+        }
+
+        double staticEdgeWeight(const CampusMap::PathChange& before) const {
+            if (before.wasClosed) return numeric_limits<double>::infinity();
+            return (alpha * before.oldDistance) + (beta * before.oldDifficulty) + gamma;
+        }
+
+        static bool tight(double reached, double dist) {
+            return abs(reached - dist) <= 1e-9 * max(1.0, abs(dist));
+        }
+
+        // Repair single-source static distances after the weight of edge e went
+        // from oldWeight to newWeight, touching only nodes whose distance changes.
+        // weightOf gives every edge's weight as of this change; reverse selects
+        // distances towards the source along in-edges. A decrease propagates like
+        // Dijkstra from the edge head; an increase first collects the nodes left
+        // without a tight unaffected predecessor (in distance order), then
+        // re-settles just those.
+        template<class Weight>
+        void repairDistances(vector<double>& dist, int source, int e, double oldWeight, double newWeight,
+                             bool reverse, Weight weightOf) {
+            const CampusGraph& g = campus->getGraph();
+            int tail = reverse ? g.target[e] : g.source[e];
+            int head = reverse ? g.source[e] : g.target[e];
+            if (newWeight == oldWeight || head == source || dist[tail] == INT_MAX) return;
+
+            // Edges leaving / entering x in the search direction, with the far endpoint
+            auto forEachOut = [&](int x, auto visit) {
+                int first = reverse ? g.inOffset[x] : g.offset[x];
+                int last = reverse ? g.inOffset[x + 1] : g.offset[x + 1];
+                for (int i = first; i < last; i++) {
+                    int f = reverse ? g.inEdge[i] : i;
+                    visit(f, reverse ? g.source[f] : g.target[f]);
+                }
+            };
+            auto forEachIn = [&](int x, auto visit) {
+                int first = reverse ? g.offset[x] : g.inOffset[x];
+                int last = reverse ? g.offset[x + 1] : g.inOffset[x + 1];
+                for (int i = first; i < last; i++) {
+                    int f = reverse ? i : g.inEdge[i];
+                    visit(f, reverse ? g.target[f] : g.source[f]);
+                }
+            };
+
+            typedef priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> MinQueue;
+            MinQueue pq;
+            auto settle = [&](auto allowed) {
+                while (!pq.empty()) {
+                    double cost = pq.top().first;
+                    int node = pq.top().second;
+                    pq.pop();
+                    if (cost > dist[node]) continue;
+                    forEachOut(node, [&](int f, int to) {
+                        double newCost = cost + weightOf(f);
+                        if (allowed(to) && newCost < dist[to]) {
+                            dist[to] = newCost;
+                            pq.push({newCost, to});
+                        }
+                    });
+                }
+            };
+
+            if (newWeight < oldWeight) {
+                if (dist[tail] + newWeight >= dist[head]) return;
+                dist[head] = dist[tail] + newWeight;
+                pq.push({dist[head], head});
+                settle([](int) { return true; });
+                return;
+            }
+
+            if (!tight(dist[tail] + oldWeight, dist[head])) return;
+            if (repairState.size() < dist.size()) repairState.assign(dist.size(), 0);
+            const char Queued = 1, Affected = 2, Kept = 3;
+            vector<int> seen = {head};
+            vector<int> affected;
+            repairState[head] = Queued;
+            pq.push({dist[head], head});
+            while (!pq.empty()) {
+                int x = pq.top().second;
+                pq.pop();
+                bool supported = false;
+                forEachIn(x, [&](int f, int from) {
+                    if (!supported && repairState[from] != Affected && dist[from] != INT_MAX) {
+                        supported = tight(dist[from] + weightOf(f), dist[x]);
+                    }
+                });
+                if (supported) {
+                    repairState[x] = Kept;
+                    continue;
+                }
+                repairState[x] = Affected;
+                affected.push_back(x);
+                forEachOut(x, [&](int f, int to) {
+                    if (repairState[to] == 0 && dist[to] != INT_MAX && tight(dist[x] + weightOf(f), dist[to])) {
+                        repairState[to] = Queued;
+                        seen.push_back(to);
+                        pq.push({dist[to], to});
+                    }
+                });
+            }
+
+            // Best entry into the affected region from outside, then Dijkstra inside it
+            for (int x : affected) {
+                double best = INT_MAX;
+                forEachIn(x, [&](int f, int from) {
+                    if (repairState[from] != Affected && dist[from] != INT_MAX) {
+                        best = min(best, dist[from] + weightOf(f));
+                    }
+                });
+                dist[x] = best;
+                if (best != INT_MAX) pq.push({best, x});
+            }
+            settle([&](int to) { return repairState[to] == Affected; });
+            for (int x : seen) repairState[x] = 0;
+        }
+
+        // Per-search tallies, published to RoutingStats once the search ends.
+        // settledCount keeps running across the searches of one query, so the
+        // settles of this search are taken against its value at the start.
+        struct SearchCounters {
+            uint64_t pushes = 1;
+            uint64_t pops = 0;
+            uint64_t relaxations = 0;
+            int settledBefore;
+
+            explicit SearchCounters(int settledCount) : settledBefore(settledCount) {}
+
+            void publish(int settledCount) const {
+                uint64_t settled = settledCount - settledBefore;
+                STAT_ADD(HeapPushes, pushes);
+                STAT_ADD(HeapPops, pops);
+                STAT_ADD(StalePops, pops - settled);
+                STAT_ADD(Relaxations, relaxations);
+                STAT_ADD(SettledNodes, settled);
+            }
+        };
+
+        // Plain Dijkstra over static weights, along in-edges when reverse is set
+        vector<double> staticDistances(int source, bool reverse) const {
+            const CampusGraph& g = campus->getGraph();
+            vector<double> dist(g.nodeCount, INT_MAX);
+            dist[source] = 0;
+            priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> pq;
+            pq.push({0, source});
+            while (!pq.empty()) {
+                double cost = pq.top().first;
+                int node = pq.top().second;
+                pq.pop();
+                if (cost > dist[node]) continue;
+
+                int first = reverse ? g.inOffset[node] : g.offset[node];
+                int last = reverse ? g.inOffset[node + 1] : g.offset[node + 1];
+                for (int i = first; i < last; i++) {
+                    int e = reverse ? g.inEdge[i] : i;
+                    int to = reverse ? g.source[e] : g.target[e];
+                    double newCost = dist[node] + staticEdgeWeight(g, e);
+                    if (newCost < dist[to]) {
+                        dist[to] = newCost;
+                        pq.push({newCost, to});
+                    }
+                }
+            }
+            return dist;
+        }
+
+        // Farthest-point landmark selection, redone whenever the topology changes
+        void refreshLandmarks() {
+            if (landmarksBuilt && landmarksTopology == campus->getTopologyEpoch()) {
+                // Same edges, some reweighted or closed: repair the tables in place,
+                // one change at a time, with later changes not yet applied
+                const CampusGraph& g = campus->getGraph();
+                const auto& changes = campus->getPathChanges();
+                int first = campus->firstPathChangeAfter(landmarksPathEpoch);
+                unordered_map<int, double> pending; // Edge -> weight before its next unapplied change
+                vector<double> newWeights(changes.size() - first);
+                for (int i = changes.size() - 1; i >= first; i--) {
+                    int e = changes[i].edge;
+                    auto it = pending.find(e);
+                    newWeights[i - first] = it == pending.end() ? staticEdgeWeight(g, e) : it->second;
+                    pending[e] = staticEdgeWeight(changes[i]);
+                }
+                auto weightOf = [&](int f) {
+                    auto it = pending.find(f);
+                    return it == pending.end() ? staticEdgeWeight(g, f) : it->second;
+                };
+                for (int i = first; i < changes.size(); i++) {
+                    int e = changes[i].edge;
+                    double oldWeight = pending[e];
+                    double newWeight = newWeights[i - first];
+                    pending[e] = newWeight;
+                    for (int l = 0; l < landmarks.size(); l++) {
+                        repairDistances(fromLandmark[l], landmarks[l], e, oldWeight, newWeight, false, weightOf);
+                        repairDistances(toLandmark[l], landmarks[l], e, oldWeight, newWeight, true, weightOf);
+                    }
+                }
+                landmarksPathEpoch = campus->getPathEpoch();
+                return;
+            }
+            const CampusGraph& g = campus->getGraph();
+            landmarks.clear();
+            fromLandmark.clear();
+            toLandmark.clear();
+
+            vector<double> closest(g.nodeCount, INT_MAX); // Distance to nearest chosen landmark
+            int next = 0;
+            while (g.nodeCount > 0 && landmarks.size() < min(landmarkCount, g.nodeCount)) {
+                landmarks.push_back(next);
+                fromLandmark.push_back(staticDistances(next, false));
+                toLandmark.push_back(staticDistances(next, true));
+
+                next = -1;
+                double farthest = -1;
+                for (int v = 0; v < g.nodeCount; v++) {
+                    double d = min(fromLandmark.back()[v], toLandmark.back()[v]);
+                    closest[v] = min(closest[v], d);
+                    if (closest[v] != INT_MAX && closest[v] > farthest) {
+                        farthest = closest[v];
+                        next = v;
+                    }
+                }
+                if (next == -1 || farthest == 0) break;
+            }
+            landmarksBuilt = true;
+            landmarksTopology = campus->getTopologyEpoch();
+            landmarksPathEpoch = campus->getPathEpoch();
+        }
+
+        // Triangle-inequality lower bound on the cost from u to t
+        double lowerBound(int u, int t) const {
+            double bound = 0;
+            for (int i = 0; i < landmarks.size(); i++) {
+                const vector<double>& from = fromLandmark[i];
+                const vector<double>& to = toLandmark[i];
+                if (from[t] != INT_MAX && from[u] != INT_MAX) bound = max(bound, from[t] - from[u]);
+                if (to[u] != INT_MAX && to[t] != INT_MAX) bound = max(bound, to[u] - to[t]);
+            }
+            return bound;
+        }
+
+        // A* search guided by the landmark lower bounds. Keys are not monotone
+        // under rounding, so this always uses the indexed heap.
+        pair<vector<int>,double> findPathALT(int start, int end) {
+            refreshEdgeWeights();
+            refreshLandmarks();
+            const CampusGraph& g = campus->getGraph();
+            int n = g.nodeCount;
+            SearchWorkspace& ws = workspace();
+            ws.prepare(n);
+            vector<double>& distances = ws.tree.distances;
+            vector<double>& heuristic = ws.scratch;
+            distances[start] = 0;
+            heuristic[start] = lowerBound(start, end);
+            ws.touched.push_back(start);
+
+            IndexedDaryHeap<4>& pq = queue<IndexedDaryHeap<4>>();
+            pq.reset(n);
+            pq.push(heuristic[start], start);
+            SearchCounters counters(settledCount);
+
+            while (!pq.empty()) {
+                pair<double, int> top = pq.pop();
+                int node = top.second;
+                counters.pops++;
+
+                if (top.first > distances[node] + heuristic[node]) continue;
+                settledCount++;
+                if (node == end) break;
+
+                for (int e = g.offset[node]; e < g.offset[node + 1]; e++) {
+                    int to = g.target[e];
+                    double newCost = distances[node] + edgeWeights[e];
+                    counters.relaxations++;
+                    if (newCost < distances[to]) {
+                        if (distances[to] == INT_MAX) ws.touched.push_back(to);
+                        distances[to] = newCost;
+                        ws.tree.parents[to] = node;
+                        if (heuristic[to] < 0) heuristic[to] = lowerBound(to, end);
+                        pq.push(newCost + heuristic[to], to);
+                        counters.pushes++;
+                    }
+                }
+            }
+            counters.publish(settledCount);
+            return extractPath(ws.tree, end);
+        }
+
+        // Dijkstra from both ends, meeting in the middle
+        template<class Queue = IndexedDaryHeap<4>>
+        pair<vector<int>,double> findPathBidirectional(int start, int end) {
+            refreshEdgeWeights();
+            const CampusGraph& g = campus->getGraph();
+            int n = g.nodeCount;
+            SearchWorkspace& wsF = workspace(0);
+            SearchWorkspace& wsB = workspace(1);
+            wsF.prepare(n);
+            wsB.prepare(n);
+            vector<double>& distF = wsF.tree.distances;
+            vector<double>& distB = wsB.tree.distances;
+            vector<int>& parentF = wsF.tree.parents;
+            vector<int>& nextB = wsB.tree.parents; // Successor towards end
+            distF[start] = 0;
+            distB[end] = 0;
+            wsF.touched.push_back(start);
+            wsB.touched.push_back(end);
+
+            Queue& pqF = queue<Queue>(0);
+            Queue& pqB = queue<Queue>(1);
+            pqF.reset(n);
+            pqB.reset(n);
+            pqF.push(0, start);
+            pqB.push(0, end);
+            double topF = 0, topB = 0; // Smallest key each queue may still hold
+
+            double best = (start == end) ? 0 : INT_MAX;
+            int meet = (start == end) ? start : -1;
+            SearchCounters counters(settledCount);
+            counters.pushes = 2;
+
+            while (!pqF.empty() && !pqB.empty()) {
+                if (topF + topB >= best) break;
+
+                bool forward = topF <= topB;
+                Queue& pq = forward ? pqF : pqB;
+                SearchWorkspace& ws = forward ? wsF : wsB;
+                vector<double>& dist = forward ? distF : distB;
+                vector<double>& other = forward ? distB : distF;
+                vector<int>& link = forward ? parentF : nextB;
+
+                pair<double, int> top = pq.pop();
+                counters.pops++;
+                (forward ? topF : topB) = top.first;
+                double cost = top.first;
+                int node = top.second;
+                if (cost > dist[node]) continue;
+                settledCount++;
+
+                int first = forward ? g.offset[node] : g.inOffset[node];
+                int last = forward ? g.offset[node + 1] : g.inOffset[node + 1];
+                for (int i = first; i < last; i++) {
+                    int e = forward ? i : g.inEdge[i];
+                    int to = forward ? g.target[e] : g.source[e];
+                    double newCost = dist[node] + edgeWeights[e];
+                    counters.relaxations++;
+                    if (newCost < dist[to]) {
+                        if (dist[to] == INT_MAX) ws.touched.push_back(to);
+                        dist[to] = newCost;
+                        link[to] = node;
+                        pq.push(newCost, to);
+                        counters.pushes++;
+                    }
+                    if (other[to] != INT_MAX && dist[to] + other[to] < best) {
+                        best = dist[to] + other[to];
+                        meet = to;
+                    }
+                }
+            }
+            counters.publish(settledCount);
+
+            vector<int> path;
+            if (meet == -1) return {path,INT_MAX};
+            for (int at = meet; at != -1; at = parentF[at]) path.push_back(at);
+            reverse(path.begin(), path.end());
+            for (int at = nextB[meet]; at != -1; at = nextB[at]) path.push_back(at);
+            return {path,best};
+        }
+    
+        // Split the nodes into regions and find their boundary nodes. Without an
+        // assignment from setRegions, seeds are picked farthest first (as for the
+        // ALT landmarks) and every node joins the seed nearest to it under the
+        // static weights, so campuses joined by a few long roads come out as
+        // separate regions. Parts no seed reaches get a region of their own on
+        // top of the regionCount split ones.
+        void buildRegions() {
+            const CampusGraph& g = campus->getGraph();
+            int n = g.nodeCount;
+            regionOf.assign(n, -1);
+            int regions = 0;
+            if (assignedRegions.size() == n) {
+                unordered_map<int, int> dense; // Assigned label -> region
+                for (int v = 0; v < n; v++) {
+                    regionOf[v] = dense.emplace(assignedRegions[v], dense.size()).first->second;
+                }
+                regions = dense.size();
+            } else {
+                int wanted = regionCount > 0 ? regionCount : max(1, static_cast<int>(sqrt(n) / 2));
+                vector<double> closest(n, INT_MAX); // Distance to the nearest seed so far
+                priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> pq;
+                int next = n > 0 ? 0 : -1;
+                int firstUnreached = 0;
+                int split = 1; // Seeds placed by distance, the first one included
+                while (next != -1) {
+                    // The new region takes every node it is strictly nearer to
+                    closest[next] = 0;
+                    regionOf[next] = regions;
+                    pq.push({0, next});
+                    while (!pq.empty()) {
+                        double cost = pq.top().first;
+                        int node = pq.top().second;
+                        pq.pop();
+                        if (cost > closest[node]) continue;
+                        for (int e = g.offset[node]; e < g.offset[node + 1]; e++) {
+                            int to = g.target[e];
+                            double newCost = cost + staticEdgeWeight(g, e);
+                            if (newCost < closest[to]) {
+                                closest[to] = newCost;
+                                regionOf[to] = regions;
+                                pq.push({newCost, to});
+                            }
+                        }
+                    }
+                    regions++;
+
+                    next = -1;
+                    while (firstUnreached < n && closest[firstUnreached] != INT_MAX) firstUnreached++;
+                    if (firstUnreached < n) {
+                        next = firstUnreached;
+                    } else if (split < wanted) {
+                        split++;
+                        double farthest = 0;
+                        for (int v = 0; v < n; v++) {
+                            if (closest[v] > farthest) {
+                                farthest = closest[v];
+                                next = v;
+                            }
+                        }
+                    }
+                }
+            }
+
+            regionStart.assign(regions + 1, 0);
+            for (int v = 0; v < n; v++) regionStart[regionOf[v] + 1]++;
+            partial_sum(regionStart.begin(), regionStart.end(), regionStart.begin());
+            regionNodes.resize(n);
+            vector<int> fill(regionStart.begin(), regionStart.end() - 1);
+            for (int v = 0; v < n; v++) regionNodes[fill[regionOf[v]]++] = v;
+
+            // Boundary nodes by topology alone, so closing a road keeps the layout
+            vector<char> onBoundary(n, 0);
+            for (int e = 0; e < g.edgeCount(); e++) {
+                if (regionOf[g.source[e]] != regionOf[g.target[e]]) onBoundary[g.source[e]] = onBoundary[g.target[e]] = 1;
+            }
+            boundaryStart.assign(regions + 1, 0);
+            boundaryNodes.clear();
+            boundaryIndex.assign(n, -1);
+            overlayStart.assign(regions + 1, 0);
+            for (int r = 0; r < regions; r++) {
+                boundaryStart[r] = boundaryNodes.size();
+                for (int i = regionStart[r]; i < regionStart[r + 1]; i++) {
+                    int v = regionNodes[i];
+                    if (!onBoundary[v]) continue;
+                    boundaryIndex[v] = boundaryNodes.size() - boundaryStart[r];
+                    boundaryNodes.push_back(v);
+                }
+                size_t b = boundaryNodes.size() - boundaryStart[r];
+                overlayStart[r + 1] = overlayStart[r] + b * b;
+            }
+            boundaryStart[regions] = boundaryNodes.size();
+            overlayCost.assign(overlayStart[regions], INT_MAX);
+            regionDirty.assign(regions, 1);
+        }
+
+        // Dijkstra from source over the current weights that never leaves region
+        // r, stopping once target (unless -1) is settled. Runs in workspace 1.
+        const SearchWorkspace& searchRegion(int r, int source, int target) {
+            const CampusGraph& g = campus->getGraph();
+            SearchWorkspace& ws = workspace(1);
+            ws.prepare(g.nodeCount);
+            vector<double>& distances = ws.tree.distances;
+            IndexedDaryHeap<4>& pq = queue<IndexedDaryHeap<4>>(1);
+            pq.reset(g.nodeCount);
+            distances[source] = 0;
+            ws.touched.push_back(source);
+            pq.push(0, source);
+            while (!pq.empty()) {
+                int node = pq.pop().second;
+                if (node == target) break;
+                for (int e = g.offset[node]; e < g.offset[node + 1]; e++) {
+                    int to = g.target[e];
+                    if (regionOf[to] != r) continue;
+                    double newCost = distances[node] + edgeWeights[e];
+                    if (newCost < distances[to]) {
+                        if (distances[to] == INT_MAX) ws.touched.push_back(to);
+                        distances[to] = newCost;
+                        ws.tree.parents[to] = node;
+                        pq.push(newCost, to);
+                    }
+                }
+            }
+            return ws;
+        }
+
+        // Recompute the boundary-to-boundary costs of region r
+        void customizeRegion(int r) {
+            int first = boundaryStart[r];
+            int b = boundaryStart[r + 1] - first;
+            for (int i = 0; i < b; i++) {
+                const SearchWorkspace& ws = searchRegion(r, boundaryNodes[first + i], -1);
+                double* row = &overlayCost[overlayStart[r] + static_cast<size_t>(i) * b];
+                for (int j = 0; j < b; j++) row[j] = ws.tree.distances[boundaryNodes[first + j]];
+            }
+            regionDirty[r] = 0;
+            STAT_ADD(OverlayRegionUpdates, 1);
+        }
+
+        // Bring the overlay up to the campus epochs. A location whose priority or
+        // visit count changed reweights its in-edges, which the overlay holds only
+        // for the edges inside its region (edges between regions are read from
+        // the weight snapshot during the query), so only that region is redone.
+        void refreshOverlay() {
+            const CampusGraph& g = campus->getGraph();
+            if (!overlayBuilt || overlayTopology != campus->getTopologyEpoch()) {
+                buildRegions();
+            } else {
+                campus->forEachChangeAfter(overlayEpoch, [&](int v) { regionDirty[regionOf[v]] = 1; });
+                const auto& changes = campus->getPathChanges();
+                for (int i = campus->firstPathChangeAfter(overlayPathEpoch); i < changes.size(); i++) {
+                    int e = changes[i].edge;
+                    if (regionOf[g.source[e]] == regionOf[g.target[e]]) regionDirty[regionOf[g.source[e]]] = 1;
+                }
+            }
+            if (find(regionDirty.begin(), regionDirty.end(), 1) != regionDirty.end()) {
+                STAT_TIMER(OverlayCustomization);
+                for (int r = 0; r < regionDirty.size(); r++) {
+                    if (regionDirty[r]) customizeRegion(r);
+                }
+            }
+            overlayBuilt = true;
+            overlayTopology = campus->getTopologyEpoch();
+            overlayEpoch = campus->getStateEpoch();
+            overlayPathEpoch = campus->getPathEpoch();
+        }
+
+        // Two-level search: original edges inside the regions of start and end,
+        // elsewhere only the overlay (boundary-to-boundary costs plus the edges
+        // between regions). Overlay hops are expanded back into locations by a
+        // search confined to their region.
+        pair<vector<int>,double> findPathRegions(int start, int end) {
+            refreshEdgeWeights();
+            refreshOverlay();
+            const CampusGraph& g = campus->getGraph();
+            int n = g.nodeCount;
+            SearchWorkspace& ws = workspace();
+            ws.prepare(n);
+            vector<double>& distances = ws.tree.distances;
+            vector<int>& parents = ws.tree.parents;
+            vector<double>& viaOverlay = ws.scratch; // 1 when the link from the parent is an overlay hop
+            int startRegion = regionOf[start];
+            int endRegion = regionOf[end];
+            distances[start] = 0;
+            ws.touched.push_back(start);
+
+            IndexedDaryHeap<4>& pq = queue<IndexedDaryHeap<4>>();
+            pq.reset(n);
+            pq.push(0, start);
+            SearchCounters counters(settledCount);
+            auto relax = [&](int node, int to, double weight, bool overlay) {
+                double newCost = distances[node] + weight;
+                counters.relaxations++;
+                if (newCost < distances[to]) {
+                    if (distances[to] == INT_MAX) ws.touched.push_back(to);
+                    distances[to] = newCost;
+                    parents[to] = node;
+                    viaOverlay[to] = overlay;
+                    pq.push(newCost, to);
+                    counters.pushes++;
+                }
+            };
+
+            while (!pq.empty()) {
+                int node = pq.pop().second;
+                counters.pops++;
+                settledCount++;
+                if (node == end) break;
+
+                // Outside the end regions only boundary nodes are reached
+                int r = regionOf[node];
+                bool local = r == startRegion || r == endRegion;
+                if (!local) {
+                    int first = boundaryStart[r];
+                    int b = boundaryStart[r + 1] - first;
+                    int i = boundaryIndex[node];
+                    const double* row = &overlayCost[overlayStart[r] + static_cast<size_t>(i) * b];
+                    for (int j = 0; j < b; j++) {
+                        if (j != i) relax(node, boundaryNodes[first + j], row[j], true);
+                    }
+                }
+                for (int e = g.offset[node]; e < g.offset[node + 1]; e++) {
+                    if (!local && regionOf[g.target[e]] == r) continue;
+                    relax(node, g.target[e], edgeWeights[e], false);
+                }
+            }
+            counters.publish(settledCount);
+
+            vector<int> path;
+            if (distances[end] == INT_MAX) return {path,INT_MAX};
+            double cost = distances[end];
+            for (int at = end; at != start; at = parents[at]) {
+                path.push_back(at);
+                if (viaOverlay[at] != 1) continue;
+                int from = parents[at];
+                const SearchWorkspace& inner = searchRegion(regionOf[at], from, at);
+                for (int x = inner.tree.parents[at]; x != from; x = inner.tree.parents[x]) path.push_back(x);
+            }
+            path.push_back(start);
+            reverse(path.begin(), path.end());
+            return {path,cost};
+        }
+
+        // How findPathsToAll used the tree cache
+        enum class CacheUse { None, Resumed, Exact };
+
+        // Seed a one-to-many search from the cached tree of start, if there is one.
+        // If the campus has not changed since and the tree covers every target it
+        // is copied out as is (Exact). Otherwise distances are re-added along the tree edges under the current weights,
+        // which keeps them true path costs, and every edge leaving a tree node
+        // that now offers a shorter path queues its head. Dijkstra resumed from
+        // these labels ends with exact distances but re-settles only what the
+        // weight changes moved (and the frontier), so a tree survives changes to
+        // unrelated locations. When the changes moved a large part of the tree
+        // (more queued heads than a quarter of its nodes) a fresh search is
+        // cheaper: ws and pq are reset and None is returned.
+        template<class Queue>
+        CacheUse resumeCachedTree(int start, const vector<int>& targets, SearchWorkspace& ws, Queue& pq,
+                                  SearchCounters& counters) {
+            const CampusGraph& g = campus->getGraph();
+            auto it = find_if(treeCache.begin(), treeCache.end(), [&](const CachedTree& t) { return t.source == start; });
+            if (it == treeCache.end() || it->topology != campus->getTopologyEpoch()) return CacheUse::None;
+            CachedTree& entry = *it;
+            entry.lastUsed = ++treeCacheClock;
+            vector<double>& distances = ws.tree.distances;
+            vector<int>& parents = ws.tree.parents;
+
+            bool current = entry.stateEpoch == campus->getStateEpoch() && entry.pathEpoch == campus->getPathEpoch();
+            if (current) {
+                // Copy the tree in label order until the last target is in
+                vector<char>& isTarget = ws.flags;
+                int pending = 0;
+                for (int t : targets) {
+                    if (t >= 0 && t < g.nodeCount && !isTarget[t]) {
+                        isTarget[t] = 1;
+                        ws.touched.push_back(t);
+                        pending++;
+                    }
+                }
+                bool all = pending == 0;
+                for (int k = 0; k < entry.nodes.size() && (all || pending > 0); k++) {
+                    int v = entry.nodes[k], parent = entry.parents[k];
+                    if (parent != -1 && distances[parent] == INT_MAX) continue;
+                    distances[v] = entry.distances[k];
+                    parents[v] = parent;
+                    ws.touched.push_back(v);
+                    if (isTarget[v]) {
+                        isTarget[v] = 0;
+                        pending--;
+                    }
+                }
+                if (pending == 0 || entry.complete) {
+                    STAT_ADD(TreeCacheHits, 1);
+                    return CacheUse::Exact;
+                }
+                ws.prepare(g.nodeCount); // Extend the tree below
+            }
+            for (int k = 0; k < entry.nodes.size(); k++) {
+                int v = entry.nodes[k], parent = entry.parents[k];
+                if (parent != -1 && distances[parent] == INT_MAX) continue; // Cut off by a closed path
+                double d = current || parent == -1 ? entry.distances[k] : distances[parent] + edgeWeights[entry.edges[k]];
+                if (d >= INT_MAX) continue;
+                distances[v] = d;
+                parents[v] = parent;
+                ws.touched.push_back(v);
+            }
+            int queued = 0, queueLimit = entry.nodes.size() / 4 + 16;
+            for (int v : entry.nodes) {
+                if (distances[v] == INT_MAX) continue;
+                for (int e = g.offset[v]; e < g.offset[v + 1]; e++) {
+                    int to = g.target[e];
+                    double newCost = distances[v] + edgeWeights[e];
+                    counters.relaxations++;
+                    if (newCost < distances[to]) {
+                        if (distances[to] == INT_MAX) ws.touched.push_back(to);
+                        distances[to] = newCost;
+                        parents[to] = v;
+                        pq.push(newCost, to);
+                        counters.pushes++;
+                        queued++;
+                    }
+                }
+                if (queued > queueLimit) {
+                    ws.prepare(g.nodeCount);
+                    pq.reset(g.nodeCount);
+                    return CacheUse::None;
+                }
+            }
+            STAT_ADD(TreeCacheHits, 1);
+            return CacheUse::Resumed;
+        }
+
+        // Remember the final part of the search that just ran in ws: every node
+        // labelled at or below stopKey, in label order
+        void storeCachedTree(int start, SearchWorkspace& ws, double stopKey, bool resumed) {
+            const CampusGraph& g = campus->getGraph();
+            auto it = find_if(treeCache.begin(), treeCache.end(), [&](const CachedTree& t) { return t.source == start; });
+            if (it == treeCache.end()) {
+                auto seen = find(treeCacheSeen.begin(), treeCacheSeen.end(), start);
+                if (seen == treeCacheSeen.end()) {
+                    if (treeCacheSeen.size() < 4 * treeCacheCapacity) treeCacheSeen.push_back(start);
+                    else treeCacheSeen[treeCacheSeenNext++ % treeCacheSeen.size()] = start;
+                    return;
+                }
+                *seen = -1;
+                if (treeCache.size() < treeCacheCapacity) {
+                    treeCache.emplace_back();
+                    it = treeCache.end() - 1;
+                } else {
+                    it = min_element(treeCache.begin(), treeCache.end(),
+                                     [](const CachedTree& a, const CachedTree& b) { return a.lastUsed < b.lastUsed; });
+                }
+            }
+            CachedTree& entry = *it;
+            entry.source = start;
+            entry.topology = campus->getTopologyEpoch();
+            entry.stateEpoch = campus->getStateEpoch();
+            entry.pathEpoch = campus->getPathEpoch();
+            entry.complete = stopKey == numeric_limits<double>::infinity();
+            entry.lastUsed = ++treeCacheClock;
+            entry.nodes.clear();
+            entry.parents.clear();
+            entry.edges.clear();
+            entry.distances.clear();
+
+            // A fresh search settled its nodes in label order. After a resumed one
+            // the final nodes are gathered (ws.scratch, reset with the workspace,
+            // marks them) and sorted. Label order lists parents first.
+            const vector<double>& distances = ws.tree.distances;
+            const vector<int>& parents = ws.tree.parents;
+            vector<int> order;
+            if (resumed) {
+                for (int v : ws.touched) {
+                    if (distances[v] >= INT_MAX || distances[v] > stopKey || ws.scratch[v] >= 0) continue;
+                    ws.scratch[v] = 1;
+                    order.push_back(v);
+                }
+                sort(order.begin(), order.end(), [&](int a, int b) { return distances[a] < distances[b]; });
+            }
+            for (int v : resumed ? order : ws.settled) {
+                int parent = parents[v], edge = -1;
+                if (parent != -1) {
+                    // The cheapest parallel edge is the one the search relaxed
+                    for (int e = g.offset[parent]; e < g.offset[parent + 1]; e++) {
+                        if (g.target[e] == v && distances[parent] + edgeWeights[e] == distances[v]) {
+                            edge = e;
+                            break;
+                        }
+                    }
+                    if (edge == -1) continue; // Label not derived from the parent's
+                }
+                entry.nodes.push_back(v);
+                entry.parents.push_back(parent);
+                entry.edges.push_back(edge);
+                entry.distances.push_back(distances[v]);
+            }
+        }
+
+    public:
+        ModifiedDijkstra(const CampusMap* c, double a = 0.6, double b = 0.3, double g = 0.1, double d = 0.2) 
+            : campus(c), alpha(a), beta(b), gamma(g), delta(d) {}
+
+        // Point the finder at another copy of the same campus, e.g. a newer
+        // snapshot; the cached weights catch up from its epochs on the next query
+        void setCampus(const CampusMap* c) { campus = c; }
+
+        void setSearchMode(SearchMode m) { mode = m; }
+        SearchMode getSearchMode() const { return mode; }
+
+        void setQueueKind(QueueKind kind) { queueKind = kind; }
+        QueueKind getQueueKind() const { return queueKind; }
+
+        // Source trees kept by findPathsToAll across queries and days; 0 disables
+        void setTreeCacheCapacity(int trees) {
+            treeCacheCapacity = max(0, trees);
+            if (treeCache.size() > treeCacheCapacity) treeCache.clear();
+            treeCacheSeen.clear();
+        }
+
+        int getTreeCacheCapacity() const { return treeCacheCapacity; }
+
+        // Number of landmarks used by ALT mode (preprocessed on the next query)
+        void setLandmarkCount(int count) {
+            landmarkCount = max(1, count);
+            landmarksBuilt = false;
+        }
+
+        // Precompute ALT landmarks now instead of on the first query
+        void prepareLandmarks() { refreshLandmarks(); }
+
+        // Number of regions Regions mode splits the campus into, 0 for sqrt(n) / 2
+        // (partitioned on the next query). Parts of the campus that cannot be
+        // reached from the rest add a region each.
+        void setRegionCount(int count) {
+            regionCount = max(0, count);
+            assignedRegions.clear();
+            overlayBuilt = false;
+        }
+
+        // Explicit partition, e.g. a campus label for every node id. Falls back
+        // to the automatic one when it does not cover every node.
+        void setRegions(const vector<int>& regionOfNode) {
+            assignedRegions = regionOfNode;
+            overlayBuilt = false;
+        }
+
+        // Partition and customize the overlay now instead of on the first query
+        void prepareRegions() {
+            refreshEdgeWeights();
+            refreshOverlay();
+        }
+
+        int getRegionCount() const { return regionStart.empty() ? 0 : regionStart.size() - 1; }
+
+        int getSettledCount() const { return settledCount; }
+
+        pair<vector<int>,double> findPath(int start, int end) {
+            STAT_ADD(FindPathCalls, 1);
+            settledCount = 0;
+            if (mode == SearchMode::ALT) return findPathALT(start, end);
+            if (mode == SearchMode::Bidirectional) {
+                if (queueKind == QueueKind::LazyBinary) return findPathBidirectional<LazyBinaryHeap>(start, end);
+                if (queueKind == QueueKind::Radix) return findPathBidirectional<RadixHeap>(start, end);
+                return findPathBidirectional(start, end);
+            }
+            if (mode == SearchMode::Regions) return findPathRegions(start, end);
+            return extractPath(findPathsToAll(start, {end}), end);
+        }
+
+        // One search from start, stops once every target is settled. The tree
+        // lives in this thread's workspace and is valid until its next search.
+        const SearchTree& findPathsToAll(int start, const vector<int>& targets) {
+            if (queueKind == QueueKind::LazyBinary) return growTree<LazyBinaryHeap>(start, targets);
+            if (queueKind == QueueKind::Radix) return growTree<RadixHeap>(start, targets);
+            return growTree<IndexedDaryHeap<4>>(start, targets);
+        }
+
+    private:
+        // findPathsToAll on one queue policy
+        template<class Queue>
+        const SearchTree& growTree(int start, const vector<int>& targets) {
+            settledCount = 0;
+            refreshEdgeWeights();
+            const CampusGraph& g = campus->getGraph();
+            int n = g.nodeCount;
+            SearchWorkspace& ws = workspace();
+            ws.prepare(n);
+            vector<double>& distances = ws.tree.distances;
+            vector<int>& parents = ws.tree.parents;
+            vector<char>& isTarget = ws.flags;
+
+            Queue& pq = queue<Queue>();
+            pq.reset(n);
+            SearchCounters counters(settledCount);
+            STAT_ADD(OneToManySearches, 1);
+            CacheUse use = treeCacheCapacity > 0 ? resumeCachedTree(start, targets, ws, pq, counters) : CacheUse::None;
+            if (use == CacheUse::Exact) return ws.tree;
+            bool resumed = use == CacheUse::Resumed;
+            ws.settled.clear();
+            if (!resumed) {
+                if (treeCacheCapacity > 0) STAT_ADD(TreeCacheMisses, 1);
+                distances[start] = 0;
+                ws.touched.push_back(start);
+                pq.push(0, start);
+            }
+
+            int pendingTargets = 0;
+            for (int t : targets) {
+                if (t >= 0 && t < n && !isTarget[t]) {
+                    isTarget[t] = 1;
+                    ws.touched.push_back(t);
+                    pendingTargets++;
+                }
+            }
+
+            // A resumed search already holds labels for targets it may never
+            // settle again; they are final once the queue has passed them
+            auto pendingBound = [&]() {
+                double bound = 0;
+                for (int t : targets) {
+                    if (t >= 0 && t < n && isTarget[t]) bound = max(bound, distances[t]);
+                }
+                return bound;
+            };
+            double targetBound = -1;
+            double stopKey = numeric_limits<double>::infinity(); // Labels up to here are final
+    
+            while (!pq.empty()) {
+                pair<double, int> top = pq.pop();
+                int node = top.second;
+                counters.pops++;
+    
+                if (top.first > distances[node]) continue;
+                if (resumed && pendingTargets > 0 && top.first >= targetBound) {
+                    targetBound = pendingBound();
+                    if (targetBound <= top.first) {
+                        stopKey = top.first;
+                        break;
+                    }
+                }
+                settledCount++;
+                ws.settled.push_back(node);
+
+                // Settled nodes never improve, so stop after the last target
+                if (isTarget[node]) {
+                    isTarget[node] = 0;
+                    if (--pendingTargets == 0) {
+                        stopKey = top.first;
+                        break;
+                    }
+                }
+    
+                for (int e = g.offset[node]; e < g.offset[node + 1]; e++) {
+                    int to = g.target[e];
+                    double newCost = distances[node] + edgeWeights[e];
+                    counters.relaxations++;
+    
+                    if (newCost < distances[to]) {
+                        if (distances[to] == INT_MAX) ws.touched.push_back(to);
+                        distances[to] = newCost;
+                        parents[to] = node;
+                        pq.push(newCost, to);
+                        counters.pushes++;
+                    }
+                }
+            }
+            counters.publish(settledCount);
+            if (treeCacheCapacity > 0) storeCachedTree(start, ws, stopKey, resumed);
+            return ws.tree;
+        }
+
+    public:
+        // Walk the parent links of a tree back from end
+        pair<vector<int>,double> extractPath(const SearchTree& tree, int end) const {
+            vector<int> path;
+            if (end < 0 || end >= tree.distances.size() || tree.distances[end] == INT_MAX) {
+                // No path exists
+                return {path,INT_MAX};
+            }
+            
+            for (int at = end; at != -1; at = tree.parents[at]) {
+                path.push_back(at);
+            }
+            reverse(path.begin(), path.end());
+            return {path,tree.distances[end]};
+        }
+    };
+    
+    // Contraction hierarchy over the static cost (alpha * distance + beta * difficulty)
+    // for high-volume distance queries between maintenance cycles
+    class ContractionHierarchy {
+    private:
+        struct ChEdge {
+            int to;
+            double weight;
+            int middle; // Contracted node this shortcut bypasses, -1 for an original path
+        };
+
+        CampusMap* campus;
+        double alpha, beta;
+        int witnessLimit = 500;  // Settled-node budget of a witness search
+        int estimateLimit = 50;  // Smaller budget while only ranking nodes
+
+        bool built = false;
+        uint64_t builtTopology = 0;
+        uint64_t builtPathEpoch = 0;
+        vector<int> builtDegree;  // Out-degree of every node when the index was last synced
+        uint64_t builtHash = 0;   // Hash of those edges
+        vector<int> rank;
+        vector<vector<ChEdge>> up;   // u -> w with rank[w] > rank[u]
+        vector<vector<ChEdge>> down; // Stored at u: w -> u with rank[w] > rank[u]
+
+        // Query workspace, reset through the touched list
+        vector<double> distF, distB;
+        vector<int> parentF, parentB, middleF, middleB;
+        vector<int> touched;
+        vector<double> witnessDist; // Witness search workspace, all INT_MAX between searches
+
+        double staticWeight(const Path& p) const { return (alpha * p.distance) + (beta * p.difficulty); }
+
+        static uint64_t mix(uint64_t h, uint64_t v) {
+            h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return h;
+        }
+
+        // Hash of the first degree[u] paths of every node
+        uint64_t hashEdges(const vector<int>& degree) const {
+            const auto& adjList = campus->getAdjacencyList();
+            uint64_t h = mix(0, degree.size());
+            uint64_t bits;
+            memcpy(&bits, &alpha, sizeof bits); h = mix(h, bits);
+            memcpy(&bits, &beta, sizeof bits); h = mix(h, bits);
+            for (int u = 0; u < degree.size(); u++) {
+                for (int k = 0; k < degree[u]; k++) {
+                    const Path& p = adjList[u][k];
+                    h = mix(h, p.to);
+                    memcpy(&bits, &p.distance, sizeof bits); h = mix(h, bits);
+                    memcpy(&bits, &p.difficulty, sizeof bits); h = mix(h, bits);
+                    h = mix(h, p.closed);
+                }
+            }
+            return h;
+        }
+
+        vector<int> currentDegrees() const {
+            const auto& adjList = campus->getAdjacencyList();
+            vector<int> degree(campus->getGraph().nodeCount, 0);
+            for (int u = 0; u < adjList.size(); u++) degree[u] = adjList[u].size();
+            return degree;
+        }
+
+        static void addOrTighten(vector<ChEdge>& edges, int to, double weight, int middle) {
+            for (auto& e : edges) {
+                if (e.to == to) {
+                    if (weight < e.weight) {
+                        e.weight = weight;
+                        e.middle = middle;
+                    }
+                    return;
+                }
+            }
+            edges.push_back({to, weight, middle});
+        }
+
+        // Shortcuts needed to contract v (only counted when apply is false)
+        int contractNode(int v, vector<vector<ChEdge>>& out, vector<vector<ChEdge>>& in,
+                         const vector<char>& contracted, bool apply) {
+            vector<double>& dist = witnessDist;
+            vector<int> reached;
+            int shortcuts = 0;
+
+            for (const auto& ein : in[v]) {
+                int u = ein.to;
+                if (contracted[u] || u == v) continue;
+                double maxTarget = 0;
+                for (const auto& eout : out[v]) {
+                    if (!contracted[eout.to] && eout.to != u) maxTarget = max(maxTarget, ein.weight + eout.weight);
+                }
+                if (maxTarget == 0) continue;
+
+                // Witness search from u avoiding v
+                priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> pq;
+                dist[u] = 0;
+                reached.push_back(u);
+                pq.push({0, u});
+                int settled = 0;
+                int limit = apply ? witnessLimit : estimateLimit;
+                while (!pq.empty() && settled < limit) {
+                    double cost = pq.top().first;
+                    int node = pq.top().second;
+                    pq.pop();
+                    if (cost > dist[node]) continue;
+                    if (cost > maxTarget) break;
+                    settled++;
+                    for (const auto& e : out[node]) {
+                        if (contracted[e.to] || e.to == v) continue;
+                        double newCost = cost + e.weight;
+                        if (newCost < dist[e.to]) {
+                            if (dist[e.to] == INT_MAX) reached.push_back(e.to);
+                            dist[e.to] = newCost;
+                            pq.push({newCost, e.to});
+                        }
+                    }
+                }
+
+                for (const auto& eout : out[v]) {
+                    int x = eout.to;
+                    if (contracted[x] || x == u) continue;
+                    double viaV = ein.weight + eout.weight;
+                    if (dist[x] <= viaV) continue;
+                    shortcuts++;
+                    if (apply) {
+                        addOrTighten(out[u], x, viaV, v);
+                        addOrTighten(in[x], u, viaV, v);
+                    }
+                }
+                for (int r : reached) dist[r] = INT_MAX;
+                reached.clear();
+            }
+            return shortcuts;
+        }
+
+        void build() {
+            const auto& adjList = campus->getAdjacencyList();
+            int n = campus->getGraph().nodeCount;
+            vector<vector<ChEdge>> out(n), in(n);
+            for (int u = 0; u < adjList.size(); u++) {
+                for (const auto& p : adjList[u]) {
+                    if (p.to == u || p.closed) continue;
+                    addOrTighten(out[u], p.to, staticWeight(p), -1);
+                    addOrTighten(in[p.to], u, staticWeight(p), -1);
+                }
+            }
+
+            // Contract in order of edge difference, re-evaluating lazily
+            vector<char> contracted(n, 0);
+            vector<int> contractedNeighbors(n, 0);
+            vector<int> level(n, 0); // Depth of v in the hierarchy built so far
+            witnessDist.assign(n, INT_MAX);
+            auto importance = [&](int v) {
+                int degree = in[v].size() + out[v].size();
+                int edgeDifference = contractNode(v, out, in, contracted, false) - degree;
+                return 2 * edgeDifference + contractedNeighbors[v] + level[v];
+            };
+            priority_queue<pair<int, int>, vector<pair<int, int>>, greater<>> order;
+            for (int v = 0; v < n; v++) order.push({importance(v), v});
+
+            rank.assign(n, 0);
+            int nextRank = 0;
+            while (!order.empty()) {
+                int v = order.top().second;
+                order.pop();
+                if (contracted[v]) continue;
+                int current = importance(v);
+                if (!order.empty() && current > order.top().first) {
+                    order.push({current, v});
+                    continue;
+                }
+                contractNode(v, out, in, contracted, true);
+                contracted[v] = 1;
+                rank[v] = nextRank++;
+                for (const auto* edges : {&out[v], &in[v]}) {
+                    for (const auto& e : *edges) {
+                        contractedNeighbors[e.to]++;
+                        level[e.to] = max(level[e.to], level[v] + 1);
+                    }
+                }
+            }
+
+            up.assign(n, {});
+            down.assign(n, {});
+            for (int u = 0; u < n; u++) {
+                for (const auto& e : out[u]) insertEdge(u, e.to, e.weight, e.middle);
+            }
+            resetWorkspace(n);
+            builtDegree = currentDegrees();
+            builtHash = hashEdges(builtDegree);
+            builtTopology = campus->getTopologyEpoch();
+            builtPathEpoch = campus->getPathEpoch();
+            built = true;
+        }
+
+        void insertEdge(int u, int x, double weight, int middle) {
+            if (rank[x] > rank[u]) addOrTighten(up[u], x, weight, middle);
+            else addOrTighten(down[x], u, weight, middle);
+        }
+
+        void resetWorkspace(int n) {
+            distF.assign(n, INT_MAX);
+            distB.assign(n, INT_MAX);
+            parentF.assign(n, -1);
+            parentB.assign(n, -1);
+            middleF.assign(n, -1);
+            middleB.assign(n, -1);
+            touched.clear();
+        }
+
+        // Follow addPath changes: a new path that is not shorter than the current
+        // distance is inserted as-is, anything else (including a reweighted or
+        // closed path) forces a rebuild
+        void sync() {
+            if (!built) {
+                build();
+                return;
+            }
+            if (builtTopology == campus->getTopologyEpoch() && builtPathEpoch == campus->getPathEpoch()) return;
+
+            vector<int> degree = currentDegrees();
+            bool compatible = degree.size() == builtDegree.size();
+            for (int u = 0; compatible && u < degree.size(); u++) compatible = degree[u] >= builtDegree[u];
+            if (!compatible || hashEdges(builtDegree) != builtHash) {
+                build();
+                return;
+            }
+
+            const auto& adjList = campus->getAdjacencyList();
+            for (int u = 0; u < degree.size(); u++) {
+                for (int k = builtDegree[u]; k < degree[u]; k++) {
+                    const Path& p = adjList[u][k];
+                    if (p.to == u || p.closed) continue;
+                    if (staticWeight(p) < query(u, p.to).second) {
+                        build();
+                        return;
+                    }
+                    insertEdge(u, p.to, staticWeight(p), -1);
+                }
+            }
+            builtDegree = degree;
+            builtHash = hashEdges(builtDegree);
+            builtTopology = campus->getTopologyEpoch();
+            builtPathEpoch = campus->getPathEpoch();
+        }
+
+        const ChEdge* findEdge(const vector<ChEdge>& edges, int to) const {
+            for (const auto& e : edges) {
+                if (e.to == to) return &e;
+            }
+            return nullptr;
+        }
+
+        // Expand a (possibly shortcut) edge a -> b into original nodes, b included
+        void unpack(int a, int b, int middle, vector<int>& path) const {
+            if (middle == -1) {
+                path.push_back(b);
+                return;
+            }
+            const ChEdge* first = findEdge(down[middle], a);  // a -> middle
+            const ChEdge* second = findEdge(up[middle], b);   // middle -> b
+            unpack(a, middle, first ? first->middle : -1, path);
+            unpack(middle, b, second ? second->middle : -1, path);
+        }
+
+        // Upward bidirectional search over the hierarchy
+        pair<vector<int>,double> query(int start, int end) {
+            int n = rank.size();
+            vector<int> path;
+            if (start < 0 || start >= n || end < 0 || end >= n) return {path,INT_MAX};
+
+            typedef priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> MinQueue;
+            MinQueue pqF, pqB;
+            distF[start] = 0;
+            distB[end] = 0;
+            touched.push_back(start);
+            touched.push_back(end);
+            pqF.push({0, start});
+            pqB.push({0, end});
+            double best = INT_MAX;
+            int meet = -1;
+
+            while (!pqF.empty() || !pqB.empty()) {
+                bool forward = pqB.empty() || (!pqF.empty() && pqF.top().first <= pqB.top().first);
+                MinQueue& pq = forward ? pqF : pqB;
+                if (pq.top().first >= best) {
+                    pq = MinQueue();
+                    continue;
+                }
+                vector<double>& dist = forward ? distF : distB;
+                vector<double>& other = forward ? distB : distF;
+                vector<int>& parent = forward ? parentF : parentB;
+                vector<int>& middle = forward ? middleF : middleB;
+                const vector<vector<ChEdge>>& edges = forward ? up : down;
+                const vector<vector<ChEdge>>& opposite = forward ? down : up;
+
+                double cost = pq.top().first;
+                int node = pq.top().second;
+                pq.pop();
+                if (cost > dist[node]) continue;
+                if (other[node] != INT_MAX && cost + other[node] < best) {
+                    best = cost + other[node];
+                    meet = node;
+                }
+
+                // Stall-on-demand: a higher node already reaches this one more cheaply
+                bool stalled = false;
+                for (const auto& e : opposite[node]) {
+                    if (dist[e.to] != INT_MAX && dist[e.to] + e.weight < cost) {
+                        stalled = true;
+                        break;
+                    }
+                }
+                if (stalled) continue;
+
+                for (const auto& e : edges[node]) {
+                    double newCost = cost + e.weight;
+                    if (newCost < dist[e.to]) {
+                        if (distF[e.to] == INT_MAX && distB[e.to] == INT_MAX) touched.push_back(e.to);
+                        dist[e.to] = newCost;
+                        parent[e.to] = node;
+                        middle[e.to] = e.middle;
+                        pq.push({newCost, e.to});
+                    }
+                }
+            }
+
+            if (meet != -1) {
+                vector<int> upward; // meet back to start
+                for (int at = meet; at != start; at = parentF[at]) upward.push_back(at);
+                path.push_back(start);
+                for (int i = upward.size() - 1; i >= 0; i--) {
+                    int at = upward[i];
+                    unpack(parentF[at], at, middleF[at], path);
+                }
+                for (int at = meet; at != end; at = parentB[at]) unpack(at, parentB[at], middleB[at], path);
+            }
+
+            for (int v : touched) {
+                distF[v] = distB[v] = INT_MAX;
+                parentF[v] = parentB[v] = middleF[v] = middleB[v] = -1;
+            }
+            touched.clear();
+            return {path,best};
+        }
+
+    public:
+        ContractionHierarchy(CampusMap* c, double a = 0.6, double b = 0.3) 
+            : campus(c), alpha(a), beta(b) {}
+
+        bool isBuilt() const { return built; }
+
+        // Static-cost shortest path, rebuilding or updating the index first if needed
+        pair<vector<int>,double> findPath(int start, int end) {
+            sync();
+            return query(start, end);
+        }
+
+        bool saveToFile(const string& filename) const {
+            if (!built) return false;
+            ofstream outFile(filename, ios::binary);
+            if (!outFile) {
+                cerr << "Error opening file for writing: " << filename << endl;
+                return false;
+            }
+            auto writeInt = [&](int64_t v) { outFile.write(reinterpret_cast<const char*>(&v), sizeof v); };
+            auto writeEdges = [&](const vector<vector<ChEdge>>& lists) {
+                for (const auto& edges : lists) {
+                    writeInt(edges.size());
+                    for (const auto& e : edges) {
+                        writeInt(e.to);
+                        outFile.write(reinterpret_cast<const char*>(&e.weight), sizeof e.weight);
+                        writeInt(e.middle);
+                    }
+                }
+            };
+            outFile.write("CHIX", 4);
+            writeInt(1); // Format version
+            writeInt(static_cast<int64_t>(builtHash));
+            writeInt(rank.size());
+            for (int d : builtDegree) writeInt(d);
+            for (int r : rank) writeInt(r);
+            writeEdges(up);
+            writeEdges(down);
+            outFile.close();
+            return static_cast<bool>(outFile);
+        }
+
+        // Load a persisted index; rejected unless it matches the current paths
+        bool loadFromFile(const string& filename) {
+            ifstream inFile(filename, ios::binary);
+            if (!inFile) return false;
+            auto readInt = [&]() {
+                int64_t v = 0;
+                inFile.read(reinterpret_cast<char*>(&v), sizeof v);
+                return v;
+            };
+            auto readEdges = [&](vector<vector<ChEdge>>& lists, int n) {
+                lists.assign(n, {});
+                for (auto& edges : lists) {
+                    int64_t count = readInt();
+                    if (!inFile || count < 0 || count > n) return false;
+                    for (int64_t i = 0; i < count; i++) {
+                        ChEdge e;
+                        e.to = readInt();
+                        inFile.read(reinterpret_cast<char*>(&e.weight), sizeof e.weight);
+                        e.middle = readInt();
+                        if (!inFile || e.to < 0 || e.to >= n || e.middle < -1 || e.middle >= n) return false;
+                        edges.push_back(e);
+                    }
+                }
+                return true;
+            };
+
+            char magic[4];
+            inFile.read(magic, 4);
+            if (!inFile || memcmp(magic, "CHIX", 4) != 0 || readInt() != 1) return false;
+            uint64_t hash = static_cast<uint64_t>(readInt());
+            int64_t n = readInt();
+            if (!inFile || n != campus->getGraph().nodeCount) return false;
+
+            vector<int> degree(n);
+            for (auto& d : degree) d = readInt();
+            if (!inFile || degree != currentDegrees() || hashEdges(degree) != hash) return false;
+            rank.resize(n);
+            for (auto& r : rank) r = readInt();
+            if (!inFile || !readEdges(up, n) || !readEdges(down, n)) {
+                built = false;
+                return false;
+            }
+
+            builtDegree = degree;
+            builtHash = hash;
+            builtTopology = campus->getTopologyEpoch();
+            builtPathEpoch = campus->getPathEpoch();
+            resetWorkspace(n);
+            built = true;
+            return true;
+        }
+    };
+    
+    // Thread pool with one task deque per worker: workers pop their own newest
+    // task and steal the oldest task of another worker when they run dry
+    class WorkStealingPool {
+    private:
+        struct WorkerQueue {
+            deque<function<void()>> tasks;
+            mutex lock;
+        };
+
+        vector<unique_ptr<WorkerQueue>> queues;
+        vector<thread> threads;
+        atomic<int> queued{0};
+        atomic<unsigned> nextQueue{0};
+        bool stopping = false;
+        mutex stateLock;
+        condition_variable wake;
+
+        // Index of the calling worker in this pool, -1 for outside threads
+        int selfIndex() const {
+            return currentPool() == this ? currentWorker() : -1;
+        }
+        static const WorkStealingPool*& currentPool() {
+            static thread_local const WorkStealingPool* pool = nullptr;
+            return pool;
+        }
+        static int& currentWorker() {
+            static thread_local int worker = -1;
+            return worker;
+        }
+
+        bool takeTask(int self, function<void()>& task) {
+            int n = queues.size();
+            if (self >= 0) {
+                lock_guard<mutex> guard(queues[self]->lock);
+                if (!queues[self]->tasks.empty()) {
+                    task = move(queues[self]->tasks.back());
+                    queues[self]->tasks.pop_back();
+                    queued--;
+                    return true;
+                }
+            }
+            int first = self >= 0 ? self + 1 : 0;
+            for (int k = 0; k < n; k++) {
+                WorkerQueue& victim = *queues[(first + k) % n];
+                lock_guard<mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    task = move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    queued--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void submit(function<void()> task) {
+            int self = selfIndex();
+            int target = self >= 0 ? self : nextQueue++ % queues.size();
+            {
+                lock_guard<mutex> guard(queues[target]->lock);
+                queues[target]->tasks.push_back(move(task));
+            }
+            {
+                lock_guard<mutex> guard(stateLock);
+                queued++;
+            }
+            wake.notify_all();
+        }
+
+        void workerLoop(int self) {
+            currentPool() = this;
+            currentWorker() = self;
+            while (true) {
+                function<void()> task;
+                if (takeTask(self, task)) {
+                    task();
+                    continue;
+                }
+                unique_lock<mutex> guard(stateLock);
+                wake.wait(guard, [&] { return stopping || queued > 0; });
+                if (stopping && queued == 0) return;
+            }
+        }
+
+    public:
+        explicit WorkStealingPool(int threadCount = 0) {
+            if (threadCount <= 0) threadCount = max(1u, thread::hardware_concurrency());
+            for (int i = 0; i < threadCount; i++) queues.push_back(make_unique<WorkerQueue>());
+            for (int i = 0; i < threadCount; i++) threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+
+        ~WorkStealingPool() {
+            {
+                lock_guard<mutex> guard(stateLock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& t : threads) t.join();
+        }
+
+        int size() const { return threads.size(); }
+
+        // Run body(0) .. body(count - 1) on the pool and wait for all of them.
+        // The caller helps with queued work, so nested calls from tasks are safe.
+        template<class Body>
+        void parallelFor(int count, Body body) {
+            auto remaining = make_shared<atomic<int>>(count);
+            for (int i = 0; i < count; i++) {
+                submit([this, remaining, &body, i] {
+                    body(i);
+                    if (--*remaining == 0) {
+                        lock_guard<mutex> guard(stateLock);
+                        wake.notify_all();
+                    }
+                });
+            }
+            int self = selfIndex();
+            while (*remaining > 0) {
+                function<void()> task;
+                if (takeTask(self, task)) {
+                    task();
+                    continue;
+                }
+                unique_lock<mutex> guard(stateLock);
+                wake.wait(guard, [&] { return *remaining == 0 || queued > 0; });
+            }
+        }
+    };
+    
+    // Maintenance Scheduler for generating daily routes
+    class MaintenanceScheduler {
+    private:
+        CampusMap* campus;
+        ModifiedDijkstra* pathFinder;
+        double visitFraction = 1.0 / 3; // Share of locations scheduled each day
+        long long improvementBudget = 0;  // Local search work per daily route (see improveTour), 0 keeps the greedy route
+        WorkStealingPool* searchPool = nullptr; // Runs the cost matrix searches when set
+        vector<ModifiedDijkstra> searchFinders; // One per pool worker, kept so their tree caches last
+        vector<ModifiedDijkstra> crewFinders;   // Same for the pool that plans crew routes
+
+        // Largest stop count that gets a cost matrix (32 MB of doubles)
+        static const int MaxMatrixStops = 2048;
+        
+    public:
+        MaintenanceScheduler(CampusMap* c, ModifiedDijkstra* d) 
+            : campus(c), pathFinder(d) {}
+
+        void setVisitFraction(double fraction) { visitFraction = fraction; }
+
+        // The budget counts work rather than time, so a run's routes do not
+        // depend on the machine or its load
+        void setRouteImprovement(long long budget, WorkStealingPool* pool = nullptr) {
+            improvementBudget = budget;
+            searchPool = pool;
+            searchFinders.clear();
+        }
+        
+        pair<vector<int>,double> generateDailyRoutes(int startLocation) {
+            STAT_TIMER(DailyRoutes);
+            // Update campus cleanliness status
+            campus->updateCleanlinessStatus(1);
+            vector<int> priorityLocations = selectPriorityLocations();
+                
+            // Plan route to visit these locations, then shorten it by local search
+            vector<int> visitOrder;
+            pair<vector<int>,double> routeAndcost = planRoute(startLocation, priorityLocations, *pathFinder, &visitOrder);
+            if (improvementBudget > 0) routeAndcost = improveRoute(startLocation, visitOrder, routeAndcost);
+            vector<int> route = routeAndcost.first;
+            double cost = routeAndcost.second;
+                
+            // Mark visited locations as cleaned
+            for (int loc : route) {
+                campus->cleanLocation(loc);
+            }
+               
+            return {route,cost};
+        }
+
+        // Split today's priority locations among crews starting at the given depots
+        // and plan every crew's route concurrently, balancing the longest route.
+        // Without depots nothing is planned and the day does not advance.
+        vector<pair<vector<int>,double>> generateMultiCrewRoutes(const vector<int>& depots, WorkStealingPool& pool) {
+            int crews = depots.size();
+            if (crews < 1) return {};
+            campus->updateCleanlinessStatus(1);
+            vector<int> priorityLocations = selectPriorityLocations();
+
+            // Graph distance from every depot to every priority location
+            vector<vector<double>> depotDistance(crews);
+            for (int c = 0; c < crews; c++) {
+                const ModifiedDijkstra::SearchTree& tree = pathFinder->findPathsToAll(depots[c], priorityLocations);
+                for (int loc : priorityLocations) depotDistance[c].push_back(pathFinder->extractPath(tree, loc).second);
+            }
+
+            // Start from a nearest-depot clustering with equal crew capacities,
+            // placing first the locations that lose most by going to their second choice
+            int count = priorityLocations.size();
+            int capacity = (count + crews - 1) / crews;
+            vector<double> regret(count, 0);
+            for (int i = 0; i < count; i++) {
+                double nearest = INT_MAX, second = INT_MAX;
+                for (int c = 0; c < crews; c++) {
+                    double d = depotDistance[c][i];
+                    if (d < nearest) {
+                        second = nearest;
+                        nearest = d;
+                    } else if (d < second) {
+                        second = d;
+                    }
+                }
+                regret[i] = second - nearest;
+            }
+            vector<int> order(count);
+            iota(order.begin(), order.end(), 0);
+            stable_sort(order.begin(), order.end(), [&](int a, int b) { return regret[a] > regret[b]; });
+
+            vector<vector<int>> assigned(crews);
+            vector<vector<int>> assignedIndex(crews); // Index into priorityLocations
+            for (int i : order) {
+                int nearest = -1;
+                for (int c = 0; c < crews; c++) {
+                    if (assigned[c].size() >= capacity) continue;
+                    if (nearest == -1 || depotDistance[c][i] < depotDistance[nearest][i]) nearest = c;
+                }
+                assigned[nearest].push_back(priorityLocations[i]);
+                assignedIndex[nearest].push_back(i);
+            }
+
+            // Crews are planned concurrently, each worker on its own path finder
+            vector<pair<vector<int>,double>> routes(crews);
+            auto solve = [&](const vector<int>& which) {
+                forEachSearch(&pool, crewFinders, which.size(), [&](ModifiedDijkstra& finder, int k) {
+                    int c = which[k];
+                    routes[c] = planRoute(depots[c], assigned[c], finder);
+                });
+            };
+            vector<int> allCrews(crews);
+            iota(allCrews.begin(), allCrews.end(), 0);
+            solve(allCrews);
+
+            // Rebalance: move the cheapest-to-transfer location off the longest route
+            // when that lowers the longer of the two routes involved
+            set<pair<int, int>> rejected; // (location index, crew) moves that did not help
+            for (int round = 0; round < 4 * crews; round++) {
+                int longest = 0;
+                for (int c = 1; c < crews; c++) {
+                    if (routes[c].second > routes[longest].second) longest = c;
+                }
+                int bestK = -1, bestCrew = -1;
+                double bestPenalty = INT_MAX;
+                for (int k = 0; k < assigned[longest].size(); k++) {
+                    int i = assignedIndex[longest][k];
+                    for (int c = 0; c < crews; c++) {
+                        if (c == longest || depotDistance[c][i] == INT_MAX || rejected.count({i, c})) continue;
+                        double penalty = depotDistance[c][i] - depotDistance[longest][i];
+                        if (penalty < bestPenalty) {
+                            bestPenalty = penalty;
+                            bestK = k;
+                            bestCrew = c;
+                        }
+                    }
+                }
+                if (bestK == -1) break;
+
+                vector<pair<vector<int>,double>> previous = {routes[longest], routes[bestCrew]};
+                int moved = assigned[longest][bestK], movedIndex = assignedIndex[longest][bestK];
+                assigned[longest].erase(assigned[longest].begin() + bestK);
+                assignedIndex[longest].erase(assignedIndex[longest].begin() + bestK);
+                assigned[bestCrew].push_back(moved);
+                assignedIndex[bestCrew].push_back(movedIndex);
+                solve({longest, bestCrew});
+
+                if (max(routes[longest].second, routes[bestCrew].second) >= previous[0].second) {
+                    // No improvement: undo and try another move next round
+                    rejected.insert({movedIndex, bestCrew});
+                    assigned[bestCrew].pop_back();
+                    assignedIndex[bestCrew].pop_back();
+                    assigned[longest].insert(assigned[longest].begin() + bestK, moved);
+                    assignedIndex[longest].insert(assignedIndex[longest].begin() + bestK, movedIndex);
+                    routes[longest] = previous[0];
+                    routes[bestCrew] = previous[1];
+                }
+            }
+
+            // Mark visited locations as cleaned
+            for (const auto& route : routes) {
+                for (int loc : route.first) campus->cleanLocation(loc);
+            }
+            return routes;
+        }
+        
+    private:
+        // Today's highest-priority locations, about visitFraction of the campus
+        vector<int> selectPriorityLocations() {
+            STAT_TIMER(PrioritySelection);
+            // Take top priorities (about visitFraction of locations each day;
+            // the tolerance keeps e.g. 1/3 of 12 at exactly 4)
+            int locationsToVisit = max(1, static_cast<int>(campus->getLocationCount() * visitFraction + 1e-9));
+            return campus->topPriorityLocations(locationsToVisit);
+        }
+
+        // Helper function to plan a route visiting all specified destinations;
+        // visitOrder, when given, receives the destinations in the order reached
+        pair<vector<int>,double> planRoute(int start, vector<int> destinations, ModifiedDijkstra& finder,
+                                           vector<int>* visitOrder = nullptr) {
+            STAT_TIMER(RoutePlanning);
+            STAT_ADD(PlanRouteCalls, 1);
+            vector<int> route = {start};
+            int currentLocation = start;
+            double totalCost = 0;
+            
+            // Greedy seed route: visit the cheapest unvisited destination next
+            while (!destinations.empty()) {
+                double bestCost = INT_MAX;
+                int bestDest = -1;
+                int bestIndex = -1;
+                
+                // One search settles every remaining destination
+                STAT_ADD(PlanRouteSteps, 1);
+                const ModifiedDijkstra::SearchTree& tree = finder.findPathsToAll(currentLocation, destinations);
+                
+                for (int i = 0; i < destinations.size(); i++) {
+                    if (destinations[i] == currentLocation) continue;
+                    double cost = tree.distances[destinations[i]]; // INT_MAX when unreachable
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestDest = destinations[i];
+                        bestIndex = i;
+                    }
+                }
+                
+                if (bestDest == -1) {
+                    // No reachable destination
+                    break;
+                }
+                
+                // Reuse the same tree for the path to the best destination
+                pair<vector<int>,double> path_cost = finder.extractPath(tree, bestDest);
+                vector<int> path = path_cost.first;
+                double cost = path_cost.second;
+                totalCost += cost;
+                
+                // Add all intermediate nodes to the route (excluding the first, which is current location)
+                for (int i = 1; i < path.size(); i++) {
+                    route.push_back(path[i]);
+                }
+                
+                // Update current location
+                currentLocation = bestDest;
+                if (visitOrder) visitOrder->push_back(bestDest);
+                
+                // Remove the visited destination
+                destinations.erase(destinations.begin() + bestIndex);
+            }
+            
+            return {route,totalCost};
+        }
+
+        // Run body(finder, i) for every i < count, spread over the workers of pool
+        // when one is set. finders holds one path finder per worker, copied from
+        // the scheduler's once and then reused so their weights and tree caches
+        // persist. The campus does not change meanwhile, so each only reads it.
+        template<class Body>
+        void forEachSearch(WorkStealingPool* pool, vector<ModifiedDijkstra>& finders, int count, Body body) {
+            if (!pool || count < 2) {
+                for (int i = 0; i < count; i++) body(*pathFinder, i);
+                return;
+            }
+            if (finders.size() != pool->size()) finders.assign(pool->size(), *pathFinder);
+            atomic<int> next{0};
+            pool->parallelFor(min(pool->size(), count), [&](int worker) {
+                for (int i; (i = next++) < count;) body(finders[worker], i);
+            });
+        }
+
+        template<class Body>
+        void forEachSearch(int count, Body body) { forEachSearch(searchPool, searchFinders, count, body); }
+
+        // Improve an open tour over an n x n cost matrix (tour[0] stays first) with
+        // 2-opt segment reversals and Or-opt moves of 1-3 stops until no move
+        // helps or the budget runs out: a candidate costs one unit, an applied move
+        // one per stop. Costs may be asymmetric. Returns the moves made.
+        static int improveTour(vector<int>& tour, const vector<double>& cost, int n, long long budget) {
+            const double eps = 1e-9;
+            int last = tour.size() - 1;
+            auto c = [&](int a, int b) { return cost[tour[a] * n + tour[b]]; }; // By tour position
+            vector<double> forward(tour.size()), backward(tour.size());
+            vector<int> blocked(tour.size()); // Unreachable arcs when walking the tour backwards
+            auto prefixSums = [&]() {
+                for (int p = 1; p <= last; p++) {
+                    double back = c(p, p - 1);
+                    forward[p] = forward[p - 1] + c(p - 1, p);
+                    blocked[p] = blocked[p - 1] + (back >= INT_MAX);
+                    backward[p] = backward[p - 1] + (back >= INT_MAX ? 0 : back);
+                }
+            };
+
+            int moves = 0;
+            bool improved = true;
+            while (improved) {
+                improved = false;
+
+                // 2-opt: reverse tour[i..j]
+                prefixSums();
+                for (int i = 1; i < last; i++) {
+                    for (int j = i + 1; j <= last && blocked[j] == blocked[i]; j++) {
+                        if (--budget < 0) return moves;
+                        double delta = c(i - 1, j) - c(i - 1, i) + (backward[j] - backward[i]) - (forward[j] - forward[i]);
+                        if (j < last) delta += c(i, j + 1) - c(j, j + 1);
+                        if (delta < -eps) {
+                            reverse(tour.begin() + i, tour.begin() + j + 1);
+                            prefixSums();
+                            budget -= last; // The move itself is linear in the tour
+                            moves++;
+                            improved = true;
+                        }
+                    }
+                }
+
+                // Or-opt: move tour[i..e] to just after tour[p]
+                for (int length = 1; length <= 3; length++) {
+                    for (int i = 1; i + length - 1 <= last; i++) {
+                        int e = i + length - 1;
+                        double gain = c(i - 1, i) + (e < last ? c(e, e + 1) - c(i - 1, e + 1) : 0);
+                        if (gain <= eps) continue;
+                        for (int p = 0; p <= last; p++) {
+                            if (p >= i - 1 && p <= e) continue;
+                            if (--budget < 0) return moves;
+                            double added = c(p, i) + (p < last ? c(e, p + 1) - c(p, p + 1) : 0);
+                            if (added - gain < -eps) {
+                                if (p < i) rotate(tour.begin() + p + 1, tour.begin() + i, tour.begin() + e + 1);
+                                else rotate(tour.begin() + i, tour.begin() + e + 1, tour.begin() + p + 1);
+                                budget -= last;
+                                moves++;
+                                improved = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+            return moves;
+        }
+
+        // Reorder the seed's visit order by local search on a cost matrix among
+        // the stops and stitch the real paths back together. Keeps the seed when
+        // there are too many stops for a matrix or nothing cheaper was found.
+        pair<vector<int>,double> improveRoute(int start, const vector<int>& visitOrder,
+                                              const pair<vector<int>,double>& seed) {
+            int n = visitOrder.size() + 1;
+            if (n < 3 || n > MaxMatrixStops) return seed;
+            vector<int> stops = {start};
+            stops.insert(stops.end(), visitOrder.begin(), visitOrder.end());
+
+            // Row i: one search from stop i settles every other stop
+            vector<double> cost(static_cast<size_t>(n) * n);
+            {
+                STAT_TIMER(CostMatrix);
+                forEachSearch(n, [&](ModifiedDijkstra& finder, int i) {
+                    const ModifiedDijkstra::SearchTree& tree = finder.findPathsToAll(stops[i], stops);
+                    for (int j = 0; j < n; j++) cost[static_cast<size_t>(i) * n + j] = tree.distances[stops[j]];
+                });
+            }
+
+            vector<int> tour(n);
+            iota(tour.begin(), tour.end(), 0);
+            {
+                STAT_TIMER(RouteImprovement);
+                int moves = improveTour(tour, cost, n, improvementBudget);
+                STAT_ADD(RouteImprovementMoves, moves);
+                if (moves == 0) return seed;
+            }
+
+            vector<pair<vector<int>,double>> legs(n - 1);
+            forEachSearch(n - 1, [&](ModifiedDijkstra& finder, int k) {
+                int from = stops[tour[k]], to = stops[tour[k + 1]];
+                legs[k] = finder.extractPath(finder.findPathsToAll(from, {to}), to);
+            });
+            vector<int> route = {start};
+            double totalCost = 0;
+            for (const auto& leg : legs) {
+                if (leg.first.empty()) return seed;
+                route.insert(route.end(), leg.first.begin() + 1, leg.first.end());
+                totalCost += leg.second;
+            }
+            if (totalCost >= seed.second) return seed;
+            return {route,totalCost};
+        }
+};
+    
+    // Utility functions for simulation
+    void displayPath(const vector<int>& path, CampusMap* campus) {
+        if (path.empty()) {
+            cout << "No path found!\n";
+            return;
+        }
+        
+        cout << "Path: ";
+        for (int i = 0; i < path.size(); i++) {
+            const Location* loc = campus->getLocationById(path[i]);
+            if (loc) {
+                cout << loc->name;
+                if (i < path.size() - 1) {
+                    cout << " -> ";
+                }
+            }
+        }
+        cout << "\n";
+    }
+    
+    // Appends one RoutingStats row per simulated day to statsFile when it is set
+    void runSimulation(CampusMap* campus, ModifiedDijkstra* pathFinder, int days, const string& statsFile = "") {
+        MaintenanceScheduler scheduler(campus, pathFinder);
+        WorkStealingPool pool;
+        scheduler.setRouteImprovement(8000000, &pool); // Roughly 50 ms of local search on 1000 stops
+        int startDepot = 0;  // Library is the starting point
+        
+        ofstream statsOut;
+        if (!statsFile.empty()) {
+            bool fresh = !ifstream(statsFile).good();
+            statsOut.open(statsFile, ios::app);
+            if (!statsOut) cerr << "Error: Could not open stats file " << statsFile << "\n";
+            else if (fresh) RoutingStats::writeCsvHeader(statsOut);
+        }
+        
+        cout << "\n=== Starting Campus Maintenance Simulation for " << days << " days ===\n";
+        campus->printLocationsStatus();
+        
+        for (int day = 0; day < days; day++) {
+            cout << "\n=== Day " << (day + 1) << " ===\n";
+            RoutingStats::Totals before = RoutingStats::snapshot();
+            pair<vector<int>,double> schedulesAndcost = scheduler.generateDailyRoutes(startDepot);
+            if (statsOut) {
+                RoutingStats::writeCsvRow(statsOut, "day" + to_string(day + 1),
+                                          RoutingStats::difference(RoutingStats::snapshot(), before));
+            }
+            vector<int> schedules = schedulesAndcost.first;
+            double cost = schedulesAndcost.second;
+            displayPath(schedules, campus);
+            cout<<"Route Cost -> "<<cost<<'\n';
+            campus->printLocationsStatus();
+        }
+    } 
+
+    void runMultiCrewSimulation(CampusMap* campus, ModifiedDijkstra* pathFinder, int days, const vector<int>& depots) {
+        MaintenanceScheduler scheduler(campus, pathFinder);
+        WorkStealingPool pool;
+        
+        cout << "\n=== Starting Multi-Crew Simulation for " << days << " days with " << depots.size() << " crews ===\n";
+        campus->printLocationsStatus();
+        
+        for (int day = 0; day < days; day++) {
+            cout << "\n=== Day " << (day + 1) << " ===\n";
+            vector<pair<vector<int>,double>> routes = scheduler.generateMultiCrewRoutes(depots, pool);
+            for (int c = 0; c < routes.size(); c++) {
+                cout << "Crew " << (c + 1) << " -> ";
+                displayPath(routes[c].first, campus);
+                cout<<"Route Cost -> "<<routes[c].second<<'\n';
+            }
+            campus->printLocationsStatus();
+        }
+    }
+
+    // One point of a parameter sweep
+    struct SweepConfig {
+        double alpha = 0.6, beta = 0.3, gamma = 0.1, delta = 0.2; // ModifiedDijkstra weight factors
+        double visitFraction = 1.0 / 3; // Share of locations scheduled each day
+    };
+
+    // Aggregate metrics of one configuration over all its replicas
+    struct SweepResult {
+        SweepConfig config;
+        double meanCleanliness = 0;  // Average over days, locations and replicas
+        double meanTotalCost = 0;    // Route cost over the whole horizon, averaged over replicas
+        int maxDaysUncleaned = 0;    // Worst lastCleaned seen in any replica
+    };
+
+    // Simulate one scenario on a private copy of the campus, headless
+    SweepResult runScenario(const CampusMap& base, const SweepConfig& config, int days, int replica) {
+        CampusMap campus = base;
+        if (replica > 0) {
+            // Monte Carlo replicas start from a randomized campus state
+            mt19937 rng(replica);
+            vector<Location> locations = campus.getLocations();
+            for (const auto& loc : locations) {
+                uniform_real_distribution<double> cleanliness(0.0, 100.0);
+                uniform_int_distribution<int> lastCleaned(0, 2 * loc.cleaningFrequency);
+                campus.setLocationState(loc.id, cleanliness(rng), lastCleaned(rng));
+            }
+        }
+
+        ModifiedDijkstra pathFinder(&campus, config.alpha, config.beta, config.gamma, config.delta);
+        MaintenanceScheduler scheduler(&campus, &pathFinder);
+        scheduler.setVisitFraction(config.visitFraction);
+
+        SweepResult result;
+        result.config = config;
+        double cleanlinessSum = 0;
+        for (int day = 0; day < days; day++) {
+            result.meanTotalCost += scheduler.generateDailyRoutes(0).second;
+            double dayCleanliness = 0;
+            const auto& locations = campus.getLocations();
+            for (const auto& loc : locations) {
+                dayCleanliness += loc.cleanlinessStatus;
+                result.maxDaysUncleaned = max(result.maxDaysUncleaned, loc.lastCleaned);
+            }
+            if (!locations.empty()) cleanlinessSum += dayCleanliness / locations.size();
+        }
+        if (days > 0) result.meanCleanliness = cleanlinessSum / days;
+        return result;
+    }
+
+    // Run every configuration for `replicas` independent scenarios across the pool
+    vector<SweepResult> runParameterSweep(const CampusMap& base, const vector<SweepConfig>& configs, 
+                                          int days, int replicas, int threads) {
+        int total = configs.size() * replicas;
+        vector<SweepResult> runs(total);
+        // Settle the lazily built views before base is shared across threads
+        base.getLocations();
+        base.getGraph();
+        WorkStealingPool pool(threads);
+        pool.parallelFor(total, [&](int i) {
+            runs[i] = runScenario(base, configs[i / replicas], days, i % replicas);
+        });
+
+        vector<SweepResult> results(configs.size());
+        for (int c = 0; c < configs.size(); c++) {
+            results[c].config = configs[c];
+            for (int r = 0; r < replicas; r++) {
+                const SweepResult& run = runs[c * replicas + r];
+                results[c].meanCleanliness += run.meanCleanliness / replicas;
+                results[c].meanTotalCost += run.meanTotalCost / replicas;
+                results[c].maxDaysUncleaned = max(results[c].maxDaysUncleaned, run.maxDaysUncleaned);
+            }
+        }
+        return results;
+    }
+
+    // Sweep file: one "alpha,beta,gamma,delta,visitFraction" configuration per line
+    bool loadSweepConfigs(const string& filename, vector<SweepConfig>& configs) {
+        ifstream inFile(filename);
+        if (!inFile) {
+            cerr << "Sweep file not found: " << filename << endl;
+            return false;
+        }
+        string line;
+        while (getline(inFile, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            SweepConfig config;
+            char c1, c2, c3, c4;
+            stringstream ss(line);
+            if (ss >> config.alpha >> c1 >> config.beta >> c2 >> config.gamma >> c3 
+                   >> config.delta >> c4 >> config.visitFraction) {
+                configs.push_back(config);
+            } else {
+                cerr << "Invalid sweep configuration: " << line << endl;
+            }
+        }
+        return true;
+    }
+
+    // --sweep <file> [--days N] [--replicas R] [--threads T] [--out results.csv]
+    int runSweepCommand(CampusMap& campus, int argc, char* argv[]) {
+        string sweepFile = argv[2];
+        string outFile;
+        int days = 90, replicas = 1, threads = 0;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            if (flag == "--days") days = atoi(argv[i + 1]);
+            else if (flag == "--replicas") replicas = max(1, atoi(argv[i + 1]));
+            else if (flag == "--threads") threads = atoi(argv[i + 1]);
+            else if (flag == "--out") outFile = argv[i + 1];
+            else cerr << "Unknown option: " << flag << endl;
+        }
+
+        vector<SweepConfig> configs;
+        if (!loadSweepConfigs(sweepFile, configs)) return 1;
+
+        vector<SweepResult> results = runParameterSweep(campus, configs, days, replicas, threads);
+
+        ofstream file;
+        if (!outFile.empty()) file.open(outFile);
+        ostream& out = outFile.empty() ? cout : file;
+        out << "alpha,beta,gamma,delta,visitFraction,days,replicas,meanCleanliness,meanTotalCost,maxDaysUncleaned\n";
+        for (const auto& r : results) {
+            out << r.config.alpha << "," << r.config.beta << "," << r.config.gamma << "," 
+                << r.config.delta << "," << r.config.visitFraction << "," << days << "," << replicas << "," 
+                << r.meanCleanliness << "," << r.meanTotalCost << "," << r.maxDaysUncleaned << "\n";
+        }
+        return 0;
+    }
+
+    // Campus-wide cleanliness summary for the long-horizon reports
+    struct HorizonSummary {
+        double meanCleanliness = 0;
+        double minCleanliness = 100;
+        int dirtyLocations = 0; // Cleanliness down to 0
+        int maxDaysUncleaned = 0;
+
+        void add(double cleanliness, int daysUncleaned) {
+            meanCleanliness += cleanliness;
+            minCleanliness = min(minCleanliness, cleanliness);
+            dirtyLocations += cleanliness <= 0;
+            maxDaysUncleaned = max(maxDaysUncleaned, daysUncleaned);
+        }
+    };
+
+    // Headless long-horizon run of the daily visit policy: each day the campus
+    // ages one day and the k highest-priority locations are cleaned. A location's
+    // cleanliness and days-since-cleaned are stored as of the day it was last
+    // touched and brought forward in closed form, so ageing the campus is O(1).
+    //
+    // Selection is event-driven when k is a small share of the campus. Between
+    // events (a cleaning, its cleanliness reaching 0, its cleaning frequency
+    // elapsing) a location's priority is linear in the day, p = key + slope * day,
+    // and locations with the same slope keep their order. So each slope holds an
+    // ordered set and the day's top k are merged from the set heads, costing
+    // O((k + events) log n) per day. When k is a large share that is slower than
+    // one closed-form pass with a linear-time selection, which is used instead.
+    class FastForwardSimulator {
+    private:
+        struct Slot {
+            int id;
+            int importance, frequency, visitPriority;
+            double rate;     // Cleanliness lost per day
+            double clean;    // Cleanliness on day `touched`
+            int last;        // Days since cleaned on day `touched`
+            int touched;
+            int nextEvent;   // Day the linear form next changes, INT_MAX if never
+            int group = -1;
+            double key = 0;
+        };
+
+        vector<Slot> slots;
+        int k;
+        bool indexed;                          // Event-driven selection, see above
+        vector<pair<double, int>> ranked;      // (-priority, slot) for the linear pass
+        vector<double> slopes;                 // Slope of each group
+        map<double, int> groupBySlope;
+        vector<set<pair<double, int>>> groups; // (-key, slot): highest priority first
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<>> events; // (day, slot)
+        int today = 0;
+
+        double cleanOn(const Slot& s, int day) const { return max(0.0, s.clean - (day - s.touched) * s.rate); }
+        int lastOn(const Slot& s, int day) const { return s.last + (day - s.touched); }
+
+        // Same formula as CampusMap::refreshPriority
+        double priorityOn(const Slot& s, int day) const {
+            int last = lastOn(s, day);
+            double timeFactorNormalized = min(1.0, static_cast<double>(last) / s.frequency);
+            timeFactorNormalized *= (last < s.frequency) ? 0.2 : 1.0;
+            return (s.importance * 0.3) + ((100 - cleanOn(s, day)) * 0.4) + (s.visitPriority * 0.1) +
+                   (timeFactorNormalized * 0.2);
+        }
+
+        int groupFor(double slope) {
+            auto it = groupBySlope.find(slope);
+            if (it != groupBySlope.end()) return it->second;
+            groupBySlope[slope] = groups.size();
+            slopes.push_back(slope);
+            groups.emplace_back();
+            return groups.size() - 1;
+        }
+
+        // Re-derive the linear form of slot i as of today and schedule its next event
+        void rekey(int i) {
+            if (!indexed) return;
+            Slot& s = slots[i];
+            if (s.group != -1) groups[s.group].erase({-s.key, i});
+            double clean = cleanOn(s, today);
+            int last = lastOn(s, today);
+            double slope = (clean > 0 ? 0.4 * s.rate : 0.0) + (last < s.frequency ? 0.04 / s.frequency : 0.0);
+            s.group = groupFor(slope);
+            s.key = priorityOn(s, today) - slope * today;
+            groups[s.group].insert({-s.key, i});
+
+            s.nextEvent = INT_MAX;
+            if (clean > 0) {
+                // First day on which the cleanliness is clamped to 0
+                int day = today + max(1, static_cast<int>(ceil(clean / s.rate)) - 1);
+                while (cleanOn(s, day) > 0) day++;
+                s.nextEvent = day;
+            }
+            if (last < s.frequency) s.nextEvent = min(s.nextEvent, today + s.frequency - last);
+            if (s.nextEvent != INT_MAX) events.push({s.nextEvent, i});
+        }
+
+    public:
+        FastForwardSimulator(const CampusMap& campus, int perDay) {
+            for (const auto& loc : campus.getLocations()) {
+                Slot s;
+                s.id = loc.id;
+                s.importance = loc.importance;
+                s.frequency = loc.cleaningFrequency;
+                s.visitPriority = loc.visitPriority;
+                s.rate = 100.0 / (loc.cleaningFrequency * 2);
+                s.clean = loc.cleanlinessStatus;
+                s.last = loc.lastCleaned;
+                s.touched = 0;
+                slots.push_back(s);
+            }
+            // Slots in id order, so the (priority, slot) orders below break ties by id
+            sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) { return a.id < b.id; });
+            k = max(0, min(perDay, static_cast<int>(slots.size())));
+            indexed = static_cast<long long>(k) * 64 <= slots.size();
+            for (int i = 0; i < slots.size(); i++) rekey(i);
+        }
+
+        int size() const { return slots.size(); }
+        int idOf(int slot) const { return slots[slot].id; }
+
+        // Age the campus one day and return the slots of the k highest-priority
+        // locations, highest first (ties go to the lower location id)
+        vector<int> advanceAndSelect() {
+            today++;
+            if (!indexed) {
+                ranked.resize(slots.size());
+                for (int i = 0; i < slots.size(); i++) ranked[i] = {-priorityOn(slots[i], today), i};
+                if (k < ranked.size()) nth_element(ranked.begin(), ranked.begin() + k, ranked.end());
+                sort(ranked.begin(), ranked.begin() + k);
+                vector<int> chosen(k);
+                for (int i = 0; i < k; i++) chosen[i] = ranked[i].second;
+                return chosen;
+            }
+
+            while (!events.empty() && events.top().first <= today) {
+                auto [day, i] = events.top();
+                events.pop();
+                if (slots[i].nextEvent == day) rekey(i); // Otherwise superseded
+            }
+
+            typedef tuple<double, int, int> Head; // (-priority, slot, group)
+            priority_queue<Head, vector<Head>, greater<>> heads;
+            vector<set<pair<double, int>>::iterator> cursor(groups.size());
+            auto pushHead = [&](int g) {
+                if (cursor[g] == groups[g].end()) return;
+                heads.push({cursor[g]->first - slopes[g] * today, cursor[g]->second, g});
+            };
+            for (int g = 0; g < groups.size(); g++) {
+                cursor[g] = groups[g].begin();
+                pushHead(g);
+            }
+            vector<int> chosen;
+            while (chosen.size() < k && !heads.empty()) {
+                int g = get<2>(heads.top());
+                chosen.push_back(get<1>(heads.top()));
+                heads.pop();
+                ++cursor[g];
+                pushHead(g);
+            }
+            return chosen;
+        }
+
+        void clean(int slot) {
+            slots[slot].clean = 100.0;
+            slots[slot].last = 0;
+            slots[slot].touched = today;
+            rekey(slot);
+        }
+
+        HorizonSummary summary() const {
+            HorizonSummary sum;
+            for (const auto& s : slots) sum.add(cleanOn(s, today), lastOn(s, today));
+            if (!slots.empty()) sum.meanCleanliness /= slots.size();
+            return sum;
+        }
+    };
+
+    // --horizon <days> [--report-every N] [--visit-fraction F] [--routing none|greedy] [--out file]
+    // Prints one CSV row of aggregates per report period. With --routing none
+    // (the default) crews clean exactly the selected locations and the run is
+    // event-driven (FastForwardSimulator); greedy plans the real daily routes
+    // through MaintenanceScheduler, which also cleans pass-through locations
+    // and reports route cost, at the price of a path search per stop.
+    int runHorizonCommand(CampusMap& campus, int argc, char* argv[]) {
+        int days = atoi(argv[2]);
+        int reportEvery = 30;
+        double visitFraction = 1.0 / 3;
+        string routing = "none", outFile;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            if (flag == "--report-every") reportEvery = max(1, atoi(argv[i + 1]));
+            else if (flag == "--visit-fraction") visitFraction = atof(argv[i + 1]);
+            else if (flag == "--routing") routing = argv[i + 1];
+            else if (flag == "--out") outFile = argv[i + 1];
+            else cerr << "Unknown option: " << flag << endl;
+        }
+        if (days <= 0 || (routing != "none" && routing != "greedy")) {
+            cerr << "Usage: --horizon <days> [--report-every N] [--visit-fraction F] [--routing none|greedy] [--out file]\n";
+            return 1;
+        }
+
+        ofstream file;
+        if (!outFile.empty()) file.open(outFile);
+        ostream& out = outFile.empty() ? cout : file;
+        out << "day,meanCleanliness,minCleanliness,dirtyLocations,maxDaysUncleaned,visits,routeCost\n";
+        long long visits = 0;
+        double routeCost = 0;
+        auto report = [&](int day, const HorizonSummary& sum) {
+            out << day << "," << sum.meanCleanliness << "," << sum.minCleanliness << "," << sum.dirtyLocations << ","
+                << sum.maxDaysUncleaned << "," << visits << "," << routeCost << "\n";
+            visits = 0;
+            routeCost = 0;
+        };
+
+        if (routing == "none") {
+            int k = max(1, static_cast<int>(campus.getLocationCount() * visitFraction + 1e-9));
+            FastForwardSimulator sim(campus, k);
+            for (int day = 1; day <= days; day++) {
+                vector<int> chosen = sim.advanceAndSelect();
+                for (int slot : chosen) sim.clean(slot);
+                visits += chosen.size();
+                if (day % reportEvery == 0 || day == days) report(day, sim.summary());
+            }
+            return 0;
+        }
+
+        CampusMap sim = campus;
+        ModifiedDijkstra pathFinder(&sim);
+        MaintenanceScheduler scheduler(&sim, &pathFinder);
+        scheduler.setVisitFraction(visitFraction);
+        for (int day = 1; day <= days; day++) {
+            pair<vector<int>,double> route = scheduler.generateDailyRoutes(0);
+            visits += route.first.size();
+            routeCost += route.second;
+            if (day % reportEvery == 0 || day == days) {
+                HorizonSummary sum;
+                const auto& locations = sim.getLocations();
+                for (const auto& loc : locations) sum.add(loc.cleanlinessStatus, loc.lastCleaned);
+                if (!locations.empty()) sum.meanCleanliness /= locations.size();
+                report(day, sum);
+            }
+        }
+        return 0;
+    }
+
+    // Queue policy named on the command line: indexed, lazy or radix
+    bool parseQueueKind(const string& name, ModifiedDijkstra::QueueKind& kind) {
+        if (name == "indexed") kind = ModifiedDijkstra::QueueKind::IndexedDary;
+        else if (name == "lazy") kind = ModifiedDijkstra::QueueKind::LazyBinary;
+        else if (name == "radix") kind = ModifiedDijkstra::QueueKind::Radix;
+        else return false;
+        return true;
+    }
+
+    // Parse a "source destination" or "source,destination" query line
+    bool parseQueryLine(const string& line, int& source, int& destination) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+        auto skip = [&] { while (p < end && (isspace(static_cast<unsigned char>(*p)) || *p == ',')) p++; };
+        skip();
+        auto first = from_chars(p, end, source);
+        if (first.ec != errc()) return false;
+        p = first.ptr;
+        skip();
+        auto second = from_chars(p, end, destination);
+        if (second.ec != errc()) return false;
+        p = second.ptr;
+        skip();
+        return p == end;
+    }
+
+    // Answer queries from `in` on `threads` workers and write one CSV line per
+    // query, in input order. Queries are read in blocks; each worker owns a
+    // copy of the primed path finder, so the shared campus is only read.
+    void runBatchQueries(CampusMap& campus, ModifiedDijkstra::SearchMode mode, ModifiedDijkstra::QueueKind queueKind,
+                         istream& in, ostream& out, int threads) {
+        const int blockSize = 1 << 14;
+        const int chunkSize = 64;
+
+        // Settle the lazily built views and the weight snapshot before sharing
+        campus.getLocations();
+        int n = campus.getGraph().nodeCount;
+        ModifiedDijkstra primed(&campus);
+        primed.setSearchMode(mode);
+        primed.setQueueKind(queueKind);
+        if (mode == ModifiedDijkstra::SearchMode::ALT) primed.prepareLandmarks();
+        if (mode == ModifiedDijkstra::SearchMode::Regions) primed.prepareRegions();
+        if (n > 0) primed.findPath(0, 0);
+
+        WorkStealingPool pool(threads);
+        vector<ModifiedDijkstra> finders(pool.size(), primed);
+
+        out << "source,destination,cost,path\n";
+        vector<string> lines;
+        vector<string> results;
+        string line;
+        bool more = true;
+        while (more) {
+            lines.clear();
+            while (lines.size() < blockSize && (more = static_cast<bool>(getline(in, line)))) {
+                if (line.empty() || line[0] == '#') continue;
+                lines.push_back(line);
+            }
+            if (lines.empty()) break;
+
+            results.assign(lines.size(), string());
+            int chunks = (lines.size() + chunkSize - 1) / chunkSize;
+            atomic<int> nextChunk{0};
+            pool.parallelFor(finders.size(), [&](int worker) {
+                ModifiedDijkstra& finder = finders[worker];
+                for (int chunk; (chunk = nextChunk++) < chunks;) {
+                    int last = min<int>(lines.size(), (chunk + 1) * chunkSize);
+                    for (int i = chunk * chunkSize; i < last; i++) {
+                        int source, destination;
+                        string& result = results[i];
+                        if (!parseQueryLine(lines[i], source, destination)) {
+                            result = ",,invalid,\n";
+                            continue;
+                        }
+                        result = to_string(source) + "," + to_string(destination) + ",";
+                        if (source < 0 || source >= n || destination < 0 || destination >= n) {
+                            result += "invalid,\n";
+                            continue;
+                        }
+                        pair<vector<int>,double> path_cost = finder.findPath(source, destination);
+                        if (path_cost.first.empty()) {
+                            result += "unreachable,\n";
+                            continue;
+                        }
+                        result += to_string(path_cost.second) + ",";
+                        for (int k = 0; k < path_cost.first.size(); k++) {
+                            if (k > 0) result += ' ';
+                            result += to_string(path_cost.first[k]);
+                        }
+                        result += '\n';
+                    }
+                }
+            });
+            for (const string& r : results) out << r;
+            out.flush();
+        }
+    }
+
+    // --batch [queries.txt|-] [--threads T] [--mode dijkstra|bidirectional|alt|regions]
+    //         [--queue indexed|lazy|radix] [--out results.csv]
+    int runBatchCommand(CampusMap& campus, int argc, char* argv[]) {
+        string queryFile = argc > 2 ? argv[2] : "-";
+        string outFile;
+        int threads = 0;
+        ModifiedDijkstra::SearchMode mode = ModifiedDijkstra::SearchMode::Dijkstra;
+        ModifiedDijkstra::QueueKind queueKind = ModifiedDijkstra::QueueKind::IndexedDary;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            string value = argv[i + 1];
+            if (flag == "--threads") threads = atoi(argv[i + 1]);
+            else if (flag == "--out") outFile = value;
+            else if (flag == "--mode" && value == "dijkstra") mode = ModifiedDijkstra::SearchMode::Dijkstra;
+            else if (flag == "--mode" && value == "bidirectional") mode = ModifiedDijkstra::SearchMode::Bidirectional;
+            else if (flag == "--mode" && value == "alt") mode = ModifiedDijkstra::SearchMode::ALT;
+            else if (flag == "--mode" && value == "regions") mode = ModifiedDijkstra::SearchMode::Regions;
+            else if (flag == "--queue") {
+                if (!parseQueueKind(value, queueKind)) cerr << "Unknown queue: " << value << endl;
+            }
+            else cerr << "Unknown option: " << flag << " " << value << endl;
+        }
+
+        ifstream inFile;
+        if (queryFile != "-") {
+            inFile.open(queryFile);
+            if (!inFile) {
+                cerr << "Query file not found: " << queryFile << endl;
+                return 1;
+            }
+        }
+        ofstream file;
+        if (!outFile.empty()) file.open(outFile);
+        istream& in = queryFile == "-" ? cin : inFile;
+        ostream& out = outFile.empty() ? cout : file;
+        runBatchQueries(campus, mode, queueKind, in, out, threads);
+        return 0;
+    }
+
+    // One published state of the served campus. The copy shares the paths and
+    // CSR arrays with the writer's campus until the writer edits them, so it costs
+    // the per-location columns. Never changed once published.
+    struct ServedCampus {
+        CampusMap campus;
+        uint64_t version;
+        int day;
+
+        ServedCampus(const CampusMap& source, uint64_t v, int d) : campus(source), version(v), day(d) {
+            // Settle the lazily built views before readers share them
+            campus.getLocations();
+            campus.getGraph();
+        }
+    };
+
+    // Resident routing service on a local Unix socket, one text command per line:
+    //   path <source> <destination>  -> ok <cost> <node> ...   | unreachable | error ...
+    //   status [<id>]                -> ok <id> <name> <cleanliness> <daysUncleaned> <priority> <visits>
+    //                                   (campus summary without an id)
+    //   version                      -> ok <version> <day>
+    //   clean <id> | advance <days> | simulate <days>  -> queued
+    //   quit (close this connection) | shutdown (stop the service)
+    // A single writer thread owns the campus and applies queued mutations in
+    // batches; after each batch it publishes a new ServedCampus by swapping an
+    // atomic pointer (read-copy-update). Connection threads pick up the current
+    // snapshot per request, so queries never wait for mutations, journal syncs
+    // or simulated days; each keeps its own path finder and only re-points it
+    // at newer snapshots, which refreshes the weights incrementally.
+    // Reclamation uses hazard slots: a reader announces the snapshot it uses in
+    // its slot and then checks that it is still current, and the writer frees a
+    // replaced snapshot once no slot names it, so all frees happen on the writer.
+    class CampusServer {
+    private:
+        struct Mutation {
+            string verb;
+            int argument;
+        };
+
+        CampusMap* campus; // Touched by the writer thread only once serving
+        CampusJournal* journal;
+        ModifiedDijkstra writerFinder;
+        MaintenanceScheduler scheduler;
+        double daySeconds; // Simulate a day this often, 0 for never
+        atomic<const ServedCampus*> current{nullptr};
+        vector<unique_ptr<ServedCampus>> published; // Writer only: current and not yet freed
+        uint64_t version = 0;
+        int day = 0;
+
+        mutex queueLock;
+        condition_variable queueReady;
+        deque<Mutation> pending;
+        bool stopping = false;
+
+        int listenFd = -1;
+        atomic<bool> shutdownRequested{false};
+        mutex clientLock;
+        set<int> clientFds;
+        list<atomic<const ServedCampus*>> readerSlots; // Snapshot each connection uses
+        vector<thread> clients;
+        vector<thread::id> finishedClients; // Ready to be joined
+
+        void publish() {
+            campus->getLocations(); // Settle the views here so the copy shares them
+            campus->getGraph();
+            published.push_back(make_unique<ServedCampus>(*campus, ++version, day));
+            current.store(published.back().get());
+
+            // Free the replaced snapshots no reader is using
+            set<const ServedCampus*> inUse;
+            {
+                lock_guard<mutex> guard(clientLock);
+                for (const auto& slot : readerSlots) inUse.insert(slot.load());
+            }
+            auto unused = [&](const unique_ptr<ServedCampus>& served) {
+                return served.get() != current.load() && !inUse.count(served.get());
+            };
+            published.erase(remove_if(published.begin(), published.end(), unused), published.end());
+        }
+
+        void simulateDay() {
+            scheduler.generateDailyRoutes(0);
+            day++;
+        }
+
+        void writerLoop() {
+            auto nextDay = chrono::steady_clock::now() + chrono::duration<double>(daySeconds);
+            while (true) {
+                deque<Mutation> batch;
+                {
+                    unique_lock<mutex> guard(queueLock);
+                    auto ready = [&] { return stopping || !pending.empty(); };
+                    if (daySeconds > 0) queueReady.wait_until(guard, nextDay, ready);
+                    else queueReady.wait(guard, ready);
+                    if (stopping && pending.empty()) return;
+                    batch.swap(pending);
+                }
+                for (const Mutation& m : batch) {
+                    if (m.verb == "clean") campus->cleanLocation(m.argument);
+                    else if (m.verb == "advance") {
+                        campus->updateCleanlinessStatus(m.argument);
+                        day += m.argument;
+                    } else {
+                        for (int i = 0; i < m.argument; i++) simulateDay();
+                    }
+                }
+                if (daySeconds > 0 && chrono::steady_clock::now() >= nextDay) {
+                    simulateDay();
+                    nextDay = chrono::steady_clock::now() + chrono::duration<double>(daySeconds);
+                }
+                journal->commit();
+                publish();
+            }
+        }
+
+        void enqueue(const string& verb, int argument) {
+            {
+                lock_guard<mutex> guard(queueLock);
+                pending.push_back({verb, argument});
+            }
+            queueReady.notify_one();
+        }
+
+        // Point slot at the current snapshot and return it; the writer will not
+        // free it while the slot names it
+        const ServedCampus* pin(atomic<const ServedCampus*>& slot) {
+            const ServedCampus* snapshot = current.load();
+            while (true) {
+                slot.store(snapshot);
+                const ServedCampus* now = current.load();
+                if (now == snapshot) return snapshot;
+                snapshot = now; // Replaced meanwhile, so perhaps already seen as unused
+            }
+        }
+
+        string answer(const string& line, atomic<const ServedCampus*>& slot, const ServedCampus*& held,
+                      ModifiedDijkstra& finder) {
+            istringstream in(line);
+            string verb;
+            in >> verb;
+            if (current.load() != held) {
+                held = pin(slot);
+                finder.setCampus(&held->campus);
+            }
+            const CampusMap& map = held->campus;
+            int n = map.getGraph().nodeCount;
+            ostringstream out;
+            out << fixed << setprecision(2);
+
+            if (verb == "path") {
+                int source, destination;
+                if (!(in >> source >> destination)) return "error usage: path <source> <destination>\n";
+                if (source < 0 || source >= n || destination < 0 || destination >= n) return "error invalid location\n";
+                pair<vector<int>,double> path_cost = finder.findPath(source, destination);
+                if (path_cost.first.empty()) return "unreachable\n";
+                out << "ok " << path_cost.second;
+                for (int v : path_cost.first) out << " " << v;
+            } else if (verb == "status") {
+                int id;
+                if (in >> id) {
+                    const Location* loc = map.getLocationById(id);
+                    if (!loc) return "error invalid location\n";
+                    out << "ok " << loc->id << " " << loc->name << " " << loc->cleanlinessStatus << " "
+                        << loc->lastCleaned << " " << map.calculateDynamicPriority(id) << " " << map.getVisitCount(id);
+                } else {
+                    HorizonSummary sum;
+                    const auto& locations = map.getLocations();
+                    for (const auto& loc : locations) sum.add(loc.cleanlinessStatus, loc.lastCleaned);
+                    if (!locations.empty()) sum.meanCleanliness /= locations.size();
+                    out << "ok locations " << locations.size() << " meanCleanliness " << sum.meanCleanliness
+                        << " dirty " << sum.dirtyLocations << " day " << held->day << " version " << held->version;
+                }
+            } else if (verb == "version") {
+                out << "ok " << held->version << " " << held->day;
+            } else if (verb == "clean" || verb == "advance" || verb == "simulate") {
+                int argument;
+                if (!(in >> argument)) return "error usage: " + verb + " <number>\n";
+                if (verb == "clean" && !map.getLocationById(argument)) return "error invalid location\n";
+                if (verb != "clean" && (argument < 1 || argument > 365)) return "error days must be 1..365\n";
+                enqueue(verb, argument);
+                return "queued\n";
+            } else {
+                return "error unknown command\n";
+            }
+            out << "\n";
+            return out.str();
+        }
+
+        static bool sendAll(int fd, const string& data) {
+            for (size_t sent = 0; sent < data.size();) {
+                ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) return false;
+                sent += n;
+            }
+            return true;
+        }
+
+        void serveClient(int fd) {
+            list<atomic<const ServedCampus*>>::iterator slot;
+            {
+                lock_guard<mutex> guard(clientLock);
+                slot = readerSlots.emplace(readerSlots.end(), nullptr);
+            }
+            const ServedCampus* held = pin(*slot);
+            ModifiedDijkstra finder(&held->campus);
+            string buffer;
+            char chunk[4096];
+            bool open = true;
+            while (open) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) break;
+                buffer.append(chunk, n);
+                size_t start = 0;
+                for (size_t end; open && (end = buffer.find('\n', start)) != string::npos; start = end + 1) {
+                    string line = buffer.substr(start, end - start);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (line.empty()) continue;
+                    if (line == "quit") open = false;
+                    else if (line == "shutdown") {
+                        sendAll(fd, "ok\n");
+                        requestShutdown();
+                        open = false;
+                    } else {
+                        open = sendAll(fd, answer(line, *slot, held, finder));
+                    }
+                }
+                buffer.erase(0, start);
+            }
+            lock_guard<mutex> guard(clientLock);
+            readerSlots.erase(slot);
+            clientFds.erase(fd);
+            finishedClients.push_back(this_thread::get_id());
+            close(fd);
+        }
+
+        // Join the threads of closed connections; clientLock must be held
+        void reapClients() {
+            for (thread::id id : finishedClients) {
+                auto it = find_if(clients.begin(), clients.end(), [&](const thread& t) { return t.get_id() == id; });
+                if (it == clients.end()) continue;
+                it->join();
+                clients.erase(it);
+            }
+            finishedClients.clear();
+        }
+
+    public:
+        CampusServer(CampusMap* c, CampusJournal* j, double secondsPerDay)
+            : campus(c), journal(j), writerFinder(c), scheduler(c, &writerFinder), daySeconds(secondsPerDay) {
+            publish();
+        }
+
+        // Unblocks accept(); safe to call from any thread
+        void requestShutdown() {
+            shutdownRequested = true;
+            if (listenFd != -1) ::shutdown(listenFd, SHUT_RDWR);
+        }
+
+        bool isShuttingDown() const { return shutdownRequested; }
+
+        // Accept connections until shutdown, then drain the writer. Returns false
+        // if the socket could not be opened.
+        bool run(const string& socketPath) {
+            sockaddr_un address{};
+            if (socketPath.size() >= sizeof(address.sun_path)) {
+                cerr << "Socket path too long: " << socketPath << endl;
+                return false;
+            }
+            address.sun_family = AF_UNIX;
+            strcpy(address.sun_path, socketPath.c_str());
+            listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            unlink(socketPath.c_str());
+            if (listenFd == -1 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                listen(listenFd, 128) != 0) {
+                cerr << "Could not listen on " << socketPath << ": " << strerror(errno) << endl;
+                if (listenFd != -1) close(listenFd);
+                listenFd = -1;
+                return false;
+            }
+            cerr << "Serving " << campus->getLocationCount() << " locations on " << socketPath << endl;
+
+            thread writer(&CampusServer::writerLoop, this);
+            while (!shutdownRequested) {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd == -1) {
+                    if (errno == EINTR || errno == ECONNABORTED) continue;
+                    break;
+                }
+                lock_guard<mutex> guard(clientLock);
+                reapClients();
+                clientFds.insert(fd);
+                clients.emplace_back(&CampusServer::serveClient, this, fd);
+            }
+
+            {
+                lock_guard<mutex> guard(clientLock);
+                for (int fd : clientFds) ::shutdown(fd, SHUT_RDWR);
+            }
+            for (auto& t : clients) t.join();
+            {
+                lock_guard<mutex> guard(queueLock);
+                stopping = true;
+            }
+            queueReady.notify_one();
+            writer.join();
+            close(listenFd);
+            listenFd = -1;
+            unlink(socketPath.c_str());
+            return true;
+        }
+    };
+
+    CampusServer* activeServer = nullptr;
+
+    void stopActiveServer(int) {
+        if (activeServer) activeServer->requestShutdown();
+    }
+
+    // --serve <socket> [--day-seconds S]
+    // Runs CampusServer until a client sends "shutdown" or the process gets
+    // SIGINT/SIGTERM, then saves the campus like menu option 5.
+    int runServeCommand(CampusMap& campus, CampusJournal& journal, int argc, char* argv[]) {
+        string socketPath = argv[2];
+        double daySeconds = 0;
+        for (int i = 3; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            if (flag == "--day-seconds") daySeconds = max(0.0, atof(argv[i + 1]));
+            else cerr << "Unknown option: " << flag << endl;
+        }
+
+        CampusServer server(&campus, &journal, daySeconds);
+        activeServer = &server;
+        struct sigaction action{};
+        action.sa_handler = stopActiveServer; // No SA_RESTART, so accept() returns EINTR
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+        bool served = server.run(socketPath);
+        activeServer = nullptr;
+        if (!served) return 1;
+
+        campus.saveToFile(BACKUP_FILE);
+        journal.compact();
+        cerr << "All data is saved." << endl;
+        return 0;
+    }
+
+    // Synthetic campus generator. Writes the usual "# Locations" / "# Paths" format.
+    //   grid:      square lattice, two-way paths between lattice neighbours
+    //   geometric: random points in the unit square joined when closer than a
+    //              radius chosen for about six neighbours each
+    //   clustered: several geometric campuses linked by a few long roads
+    bool generateCampusFile(const string& kind, int nodes, uint64_t seed, const string& filename) {
+        mt19937_64 rng(seed);
+        uniform_real_distribution<double> unit(0.0, 1.0);
+        vector<double> x(nodes), y(nodes);
+        vector<tuple<int, int, double>> links; // Undirected, written both ways
+
+        auto linkGeometric = [&](int first, int count, double radius) {
+            // Bucket points into cells of side `radius` and compare neighbouring cells only
+            int cells = max(1, static_cast<int>(1.0 / radius));
+            vector<vector<int>> grid(cells * cells);
+            auto cellOf = [&](double v) { return min(cells - 1, static_cast<int>(v * cells)); };
+            for (int i = first; i < first + count; i++) grid[cellOf(x[i]) * cells + cellOf(y[i])].push_back(i);
+            for (int i = first; i < first + count; i++) {
+                int cx = cellOf(x[i]), cy = cellOf(y[i]);
+                for (int dx = -1; dx <= 1; dx++) {
+                    for (int dy = -1; dy <= 1; dy++) {
+                        int nx = cx + dx, ny = cy + dy;
+                        if (nx < 0 || ny < 0 || nx >= cells || ny >= cells) continue;
+                        for (int j : grid[nx * cells + ny]) {
+                            double d = hypot(x[i] - x[j], y[i] - y[j]);
+                            if (j > i && d <= radius) links.push_back({i, j, d});
+                        }
+                    }
+                }
+            }
+        };
+
+        if (kind == "grid") {
+            int side = max(1, static_cast<int>(ceil(sqrt(nodes))));
+            for (int i = 0; i < nodes; i++) {
+                x[i] = (i % side) / static_cast<double>(side);
+                y[i] = (i / side) / static_cast<double>(side);
+                if (i % side + 1 < side && i + 1 < nodes) links.push_back({i, i + 1, 1.0 / side});
+                if (i + side < nodes) links.push_back({i, i + side, 1.0 / side});
+            }
+        } else if (kind == "geometric") {
+            for (int i = 0; i < nodes; i++) {
+                x[i] = unit(rng);
+                y[i] = unit(rng);
+            }
+            linkGeometric(0, nodes, sqrt(6.0 / (M_PI * max(1, nodes))));
+        } else if (kind == "clustered") {
+            int campuses = max(2, nodes / 5000);
+            int perCampus = (nodes + campuses - 1) / campuses;
+            for (int c = 0, first = 0; c < campuses && first < nodes; c++, first += perCampus) {
+                int count = min(perCampus, nodes - first);
+                for (int i = first; i < first + count; i++) {
+                    x[i] = unit(rng);
+                    y[i] = unit(rng);
+                }
+                linkGeometric(first, count, sqrt(6.0 / (M_PI * max(1, count))));
+                if (first > 0) {
+                    // A few roads to the previous campus
+                    for (int r = 0; r < 3; r++) {
+                        int a = first - 1 - static_cast<int>(unit(rng) * min(perCampus, first));
+                        int b = first + static_cast<int>(unit(rng) * count);
+                        links.push_back({a, b, 5.0 + unit(rng) * 5.0});
+                    }
+                }
+            }
+        } else {
+            cerr << "Unknown graph kind: " << kind << " (use grid, geometric or clustered)\n";
+            return false;
         }
-        cout << "\n";
-    }
 
-    // New file handling methods
-    bool saveToFile(const string& filename) {
         ofstream outFile(filename);
         if (!outFile) {
             cerr << "Error opening file for writing: " << filename << endl;
             return false;
         }
-
-        // Save locations
+        // Path lengths are scaled so a typical hop is a few units, like the sample campus
+        double scale = 3.0 * sqrt(max(1, nodes));
         outFile << "# Locations\n";
-        for (const auto& loc : locations) {
-            outFile << loc.id << ","
-                    << loc.name << ","
-                    << loc.importance << ","
-                    << loc.cleaningFrequency << ","
-                    << loc.visitPriority << ","
-                    << loc.cleanlinessStatus << ","
-                    << loc.lastCleaned << ","
-                    << visitCounts[loc.id] << "\n";
+        for (int i = 0; i < nodes; i++) {
+            int frequency = 1 + rng() % 14;
+            outFile << i << ",Location " << i << "," << (1 + rng() % 10) << "," << frequency << ","
+                    << (1 + rng() % 10) << "," << fixed << setprecision(1) << (50.0 + unit(rng) * 50.0) << ","
+                    << (rng() % (frequency + 1)) << ",0\n";
         }
-
-        // Save paths
-        outFile << "# Paths\n";
-        for (int from = 0; from < adjacencyList.size(); ++from) {
-            for (const auto& path : adjacencyList[from]) {
-                outFile << path.from << ","
-                        << path.to << ","
-                        << path.distance << ","
-                        << path.travelTime << ","
-                        << path.difficulty << "\n";
-            }
+        outFile << "# Paths\n" << setprecision(3);
+        for (const auto& link : links) {
+            int a = get<0>(link), b = get<1>(link);
+            double distance = max(0.1, get<2>(link) * scale);
+            double difficulty = 1.0 + unit(rng) * 0.5;
+            outFile << a << "," << b << "," << distance << "," << distance * 1.5 << "," << difficulty << "\n";
+            outFile << b << "," << a << "," << distance << "," << distance * 1.5 << "," << difficulty << "\n";
         }
+        return static_cast<bool>(outFile);
+    }
 
-        outFile.close();
-        return true;
+    // Latency summary of one benchmarked operation, in microseconds
+    struct BenchStats {
+        string operation;
+        int count = 0;
+        double p50 = 0, p90 = 0, p99 = 0, max = 0, mean = 0;
+        double throughput = 0; // Operations per second
+        long peakRssKb = 0;    // Peak resident set size while the operation ran
+    };
+
+    // Reset the kernel's peak-RSS mark so the next reading covers one operation
+    void resetPeakRss() {
+        ofstream clearRefs("/proc/self/clear_refs");
+        if (clearRefs) clearRefs << "5";
     }
 
-    bool loadFromFile(const string& filename) {
-        ifstream inFile(filename);
-        if (!inFile) {
-            cerr << "Data file not found. Starting with new data.\n";
-            return false;
-        }
-        locations.clear();
-        visitCounts.clear();
-        adjacencyList.clear();
-        
+    long readPeakRssKb() {
+        ifstream status("/proc/self/status");
         string line;
-        string currentSection;
-        while (getline(inFile, line)) {
-            if (line.empty()) continue;
-            // Check section headers
-            if (line == "# Locations" || line == "# Paths") {
-                currentSection = line;
-                continue;
-            }
+        while (getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) return atol(line.c_str() + 6);
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
 
-            stringstream ss(line);
-            string token;
-            vector<string> tokens;
-            while (getline(ss, token, ',')) tokens.push_back(token);
-            
-            try {
-                // Process locations
-                if (currentSection == "# Locations" && tokens.size() == 8) {
-                    Location loc(stoi(tokens[0]), tokens[1], stoi(tokens[2]), 
-                                 stoi(tokens[3]), stoi(tokens[4]), stod(tokens[5]));
-                    loc.lastCleaned = stoi(tokens[6]);
-                    locations.push_back(loc);
-                    visitCounts[loc.id] = stoi(tokens[7]);
-                } 
-                // Process paths
-                else if (currentSection == "# Paths" && tokens.size() == 5) {
-                    int from = stoi(tokens[0]);
-                    Path p(from, stoi(tokens[1]), stod(tokens[2]), 
-                           stod(tokens[3]), stod(tokens[4]));
-                    
-                    if (from >= adjacencyList.size()) adjacencyList.resize(from + 1);
-                    adjacencyList[from].push_back(p);
-                }
-                else  cerr << "Invalid format in " << currentSection << ": " << line << endl;
-            }
-            catch (const exception& e) { cerr << "Error parsing line: " << e.what() << endl; }
+    // Time op(i) for i in [0, count) and summarize the latencies
+    template<class Op>
+    BenchStats benchmarkOperation(const string& name, int count, Op op) {
+        vector<double> latencies;
+        latencies.reserve(count);
+        resetPeakRss();
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            auto start = chrono::steady_clock::now();
+            op(i);
+            latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
         }
-        
-        inFile.close();
-        return true;
+        double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+        BenchStats stats;
+        stats.operation = name;
+        stats.count = count;
+        stats.peakRssKb = readPeakRssKb();
+        if (count == 0) return stats;
+        sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) { return latencies[min(count - 1, static_cast<int>(p * count))]; };
+        stats.p50 = percentile(0.50);
+        stats.p90 = percentile(0.90);
+        stats.p99 = percentile(0.99);
+        stats.max = latencies.back();
+        stats.mean = accumulate(latencies.begin(), latencies.end(), 0.0) / count;
+        stats.throughput = totalSeconds > 0 ? count / totalSeconds : 0;
+        return stats;
     }
-};
 
-class ModifiedDijkstra {
-    private:
-        CampusMap* campus;
-        double alpha, beta, gamma, delta; // Weight factors
-    
-    public:
-        ModifiedDijkstra(CampusMap* c, double a = 0.6, double b = 0.3, double g = 0.1, double d = 0.2) 
-            : campus(c), alpha(a), beta(b), gamma(g), delta(d) {}
-    
-        pair<vector<int>,double> findPath(int start, int end) {
-            const auto& adjList = campus->getAdjacencyList();
-            int n = adjList.size();
-            vector<double> distances(n, INT_MAX);
-            vector<int> parents(n, -1);
-            distances[start] = 0;
-    
-            priority_queue<pair<double, int>, vector<pair<double, int>>, greater<>> pq;
-            pq.push({0, start});
-    
-            while (!pq.empty()) {
-                double cost = pq.top().first;
-                int node = pq.top().second;
-                pq.pop();
-    
-                if (cost > distances[node]) continue;
-    
-                for (const auto& edge : adjList[node]) {
-                    int to = edge.to;
-                    
-                    // Calculate weighted edge cost
-                    double priorityFactor = 1.0 - (campus->calculateDynamicPriority(to) / 100.0);
-                    double visitFactor = 1.0 + (campus->getVisitCount(to) * delta);
-                    
-                    double weight = (alpha * edge.distance) + 
-                                   (beta * edge.difficulty) + 
-                                   (gamma * visitFactor);
-                    
-                    // Priority reduces the cost (more important locations are easier to include)
-                    weight *= (2.0 - priorityFactor);
-                    
-                    double newCost = distances[node] + weight;
-    
-                    if (newCost < distances[to]) {
-                        distances[to] = newCost;
-                        parents[to] = node;
-                        pq.push({newCost, to});
-                    }
+    // One JSON object per line so runs can be diffed and concatenated
+    void writeBenchStats(ostream& out, const string& graph, int nodes, int edges, const BenchStats& s) {
+        out << fixed << setprecision(3)
+            << "{\"graph\":\"" << graph << "\",\"nodes\":" << nodes << ",\"edges\":" << edges
+            << ",\"operation\":\"" << s.operation << "\",\"count\":" << s.count
+            << ",\"p50_us\":" << s.p50 << ",\"p90_us\":" << s.p90 << ",\"p99_us\":" << s.p99
+            << ",\"max_us\":" << s.max << ",\"mean_us\":" << s.mean
+            << ",\"throughput_per_s\":" << s.throughput << ",\"peak_rss_kb\":" << s.peakRssKb << "}\n";
+    }
+
+    struct BenchOptions {
+        int queries = 200;         // findPath queries per search mode
+        int days = 3;              // generateDailyRoutes calls
+        int loads = 3;             // Repetitions of each loader
+        uint64_t seed = 1;
+        double visitFraction = -1; // Share visited per day; -1 picks min(1/3, 50 / locations)
+        bool hierarchy = false;    // Also build and query a contraction hierarchy
+        string queue = "indexed";  // Queue policy of the Dijkstra and bidirectional runs, "all" to compare them
+    };
+
+    void benchmarkCampusFile(const string& filename, const string& graph, const BenchOptions& options, ostream& out) {
+        CampusMap campus;
+        BenchStats load = benchmarkOperation("loadFromFile", options.loads, [&](int) { campus.loadFromFile(filename); });
+        int nodes = campus.getGraph().nodeCount, edges = campus.getGraph().edgeCount();
+        writeBenchStats(out, graph, nodes, edges, load);
+        if (nodes == 0) return;
+
+        string snapshot = filename + ".bin";
+        campus.saveSnapshot(snapshot);
+        writeBenchStats(out, graph, nodes, edges, 
+                        benchmarkOperation("loadSnapshot", options.loads, [&](int) { campus.loadSnapshot(snapshot); }));
+        remove(snapshot.c_str());
+
+        mt19937_64 rng(options.seed);
+        vector<pair<int, int>> pairs(options.queries);
+        for (auto& p : pairs) p = {static_cast<int>(rng() % nodes), static_cast<int>(rng() % nodes)};
+
+        ModifiedDijkstra pathFinder(&campus);
+        writeBenchStats(out, graph, nodes, edges, 
+                        benchmarkOperation("prepareLandmarks", 1, [&](int) { pathFinder.prepareLandmarks(); }));
+        writeBenchStats(out, graph, nodes, edges, 
+                        benchmarkOperation("prepareRegions", 1, [&](int) { pathFinder.prepareRegions(); }));
+        vector<pair<string, ModifiedDijkstra::SearchMode>> modes = {
+            {"findPath.Dijkstra", ModifiedDijkstra::SearchMode::Dijkstra},
+            {"findPath.Bidirectional", ModifiedDijkstra::SearchMode::Bidirectional},
+            {"findPath.ALT", ModifiedDijkstra::SearchMode::ALT},
+            {"findPath.Regions", ModifiedDijkstra::SearchMode::Regions}
+        };
+        // With every queue policy, each runs its own searches and must match the first one's costs
+        bool compareQueues = options.queue == "all";
+        vector<string> queues = compareQueues ? vector<string>{"indexed", "lazy", "radix"} : vector<string>{options.queue};
+        int cacheCapacity = pathFinder.getTreeCacheCapacity();
+        if (compareQueues) pathFinder.setTreeCacheCapacity(0);
+        ModifiedDijkstra::QueueKind chosen = ModifiedDijkstra::QueueKind::IndexedDary;
+        parseQueueKind(options.queue, chosen);
+        for (const auto& m : modes) {
+            pathFinder.setSearchMode(m.second);
+            bool queued = m.second == ModifiedDijkstra::SearchMode::Dijkstra ||
+                          m.second == ModifiedDijkstra::SearchMode::Bidirectional;
+            vector<double> reference;
+            for (const string& q : queued ? queues : vector<string>{"indexed"}) {
+                ModifiedDijkstra::QueueKind kind = ModifiedDijkstra::QueueKind::IndexedDary;
+                parseQueueKind(q, kind);
+                pathFinder.setQueueKind(kind);
+                vector<double> costs(pairs.size());
+                string name = queued && compareQueues ? m.first + "." + q : m.first;
+                writeBenchStats(out, graph, nodes, edges, benchmarkOperation(name, pairs.size(), [&](int i) {
+                    costs[i] = pathFinder.findPath(pairs[i].first, pairs[i].second).second;
+                }));
+                if (reference.empty()) {
+                    reference = costs;
+                    continue;
                 }
+                int differing = 0;
+                for (int i = 0; i < costs.size(); i++) {
+                    if (abs(costs[i] - reference[i]) > 1e-9 * max(1.0, abs(reference[i]))) differing++;
+                }
+                if (differing > 0) cerr << name << ": " << differing << " costs differ from the " << queues[0] << " queue\n";
             }
-    
-            vector<int> path;
-            if (distances[end] == INT_MAX) {
-                // No path exists
-                return {path,distances[end]};
-            }
-            
-            for (int at = end; at != -1; at = parents[at]) {
-                path.push_back(at);
-            }
-            reverse(path.begin(), path.end());
-            return {path,distances[end]};
         }
-    };
-    
-    // Maintenance Scheduler for generating daily routes
-    class MaintenanceScheduler {
-    private:
-        CampusMap* campus;
-        ModifiedDijkstra* pathFinder;
-        
-    public:
-        MaintenanceScheduler(CampusMap* c, ModifiedDijkstra* d) 
-            : campus(c), pathFinder(d) {}
-        
-        pair<vector<int>,double> generateDailyRoutes(int startLocation) {
-            // Update campus cleanliness status
-            campus->updateCleanlinessStatus(1);
-                
-            // Get locations-priority for today
-            vector<pair<int, double>> priorityList;
-            const auto& locations = campus->getLocations();
-            for (const auto& loc : locations) {
-                double priority = campus->calculateDynamicPriority(loc.id);
-                priorityList.push_back({loc.id, priority});
-            }
-                
-            // Sort by priority (descending)
-            sort(priorityList.begin(), priorityList.end(), 
-                [](const pair<int, double>& a, const pair<int, double>& b) {
-                return a.second > b.second;
-            });
-                
-            // Take top priorities (about 1/3 of locations each day)
-            int locationsToVisit = max(1, static_cast<int>(locations.size() / 3));
-            vector<int> priorityLocations;
-            for (int i = 0; i < min(locationsToVisit, static_cast<int>(priorityList.size())); i++) {
-                priorityLocations.push_back(priorityList[i].first);
-            }
-                
-            // Plan route to visit these locations
-            pair<vector<int>,double> routeAndcost = planRoute(startLocation, priorityLocations);
-            vector<int> route = routeAndcost.first;
-            double cost = routeAndcost.second;
-                
-            // Mark visited locations as cleaned
-            for (int loc : route) {
-                campus->cleanLocation(loc);
-            }
-               
-            return {route,cost};
+        // The scheduler runs on the chosen queue, the indexed heap when comparing
+        pathFinder.setQueueKind(chosen);
+        pathFinder.setTreeCacheCapacity(cacheCapacity);
+
+        if (options.hierarchy) {
+            ContractionHierarchy hierarchy(&campus);
+            writeBenchStats(out, graph, nodes, edges, benchmarkOperation("hierarchy.build", 1, [&](int) {
+                hierarchy.findPath(0, 0);
+            }));
+            writeBenchStats(out, graph, nodes, edges, benchmarkOperation("hierarchy.findPath", pairs.size(), [&](int i) {
+                hierarchy.findPath(pairs[i].first, pairs[i].second);
+            }));
         }
-        
-    private:
-        // Helper function to plan a route visiting all specified destinations
-        pair<vector<int>,double> planRoute(int start, vector<int> destinations) {
-            vector<int> route = {start};
-            int currentLocation = start;
-            double totalCost = 0;
-            
-            // Simple greedy approach: visit nearest unvisited high-priority location
-            while (!destinations.empty()) {
-                double bestDist = INT_MAX;
-                int bestDest = -1;
-                int bestIndex = -1;
-                
-                for (int i = 0; i < destinations.size(); i++) {
-                    pair<vector<int>,double> path_cost = pathFinder->findPath(currentLocation, destinations[i]);
-                    vector<int> path = path_cost.first;
-                    double cost = path_cost.second;
-                    
-                    if (!path.empty() && path.size() > 1) {  // Valid path exists
-                        double distance = path.size() - 1;  // Simple distance measure
-                        
-                        if (distance < bestDist) {
-                            bestDist = distance;
-                            bestDest = destinations[i];
-                            bestIndex = i;
-                        }
-                    }
-                }
-                
-                if (bestDest == -1) {
-                    // No reachable destination
-                    break;
-                }
-                
-                // Get the path to the best destination
-                pair<vector<int>,double> path_cost = pathFinder->findPath(currentLocation, bestDest);
-                vector<int> path = path_cost.first;
-                double cost = path_cost.second;
-                totalCost += cost;
-                
-                // Add all intermediate nodes to the route (excluding the first, which is current location)
-                for (int i = 1; i < path.size(); i++) {
-                    route.push_back(path[i]);
+
+        MaintenanceScheduler scheduler(&campus, &pathFinder);
+        double fraction = options.visitFraction > 0 ? options.visitFraction 
+                                                    : min(1.0 / 3, 50.0 / campus.getLocations().size());
+        scheduler.setVisitFraction(fraction);
+        writeBenchStats(out, graph, nodes, edges, benchmarkOperation("generateDailyRoutes", options.days, [&](int) {
+            scheduler.generateDailyRoutes(0);
+        }));
+    }
+
+    // --generate <grid|geometric|clustered> <nodes> <seed> <file>
+    int runGenerateCommand(int argc, char* argv[]) {
+        if (argc < 6) {
+            cerr << "Usage: --generate <grid|geometric|clustered> <nodes> <seed> <file>\n";
+            return 1;
+        }
+        return generateCampusFile(argv[2], atoi(argv[3]), strtoull(argv[4], nullptr, 10), argv[5]) ? 0 : 1;
+    }
+
+    // --bench <file> [options] benchmarks one campus file;
+    // --bench-suite [options] generates every graph kind from 1e3 nodes up to
+    // --max-nodes (default 1e6) and benchmarks each
+    int runBenchCommand(int argc, char* argv[]) {
+        bool suite = string(argv[1]) == "--bench-suite";
+        int first = suite ? 2 : 3;
+        if (!suite && argc < 3) {
+            cerr << "Usage: --bench <file> [--queries Q] [--days D] [--loads L] [--seed S] "
+                    "[--visit-fraction F] [--hierarchy] [--queue indexed|lazy|radix|all] [--out results.jsonl]\n";
+            return 1;
+        }
+        BenchOptions options;
+        string outFile;
+        int maxNodes = 1000000;
+        for (int i = first; i < argc; i++) {
+            string flag = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (flag == "--hierarchy") options.hierarchy = true;
+            else if (flag == "--queries" && hasValue) options.queries = atoi(argv[++i]);
+            else if (flag == "--days" && hasValue) options.days = atoi(argv[++i]);
+            else if (flag == "--loads" && hasValue) options.loads = atoi(argv[++i]);
+            else if (flag == "--seed" && hasValue) options.seed = strtoull(argv[++i], nullptr, 10);
+            else if (flag == "--visit-fraction" && hasValue) options.visitFraction = atof(argv[++i]);
+            else if (flag == "--max-nodes" && hasValue) maxNodes = atoi(argv[++i]);
+            else if (flag == "--out" && hasValue) outFile = argv[++i];
+            else if (flag == "--queue" && hasValue) {
+                ModifiedDijkstra::QueueKind kind;
+                options.queue = argv[++i];
+                if (options.queue != "all" && !parseQueueKind(options.queue, kind)) {
+                    cerr << "Unknown queue: " << options.queue << " (use indexed, lazy, radix or all)\n";
+                    return 1;
                 }
-                
-                // Update current location
-                currentLocation = bestDest;
-                
-                // Remove the visited destination
-                destinations.erase(destinations.begin() + bestIndex);
             }
-            
-            return {route,totalCost};
+            else cerr << "Unknown option: " << flag << endl;
         }
-};
-    
-    // Utility functions for simulation
-    void displayPath(const vector<int>& path, CampusMap* campus) {
-        if (path.empty()) {
-            cout << "No path found!\n";
-            return;
+
+        ofstream file;
+        if (!outFile.empty()) file.open(outFile);
+        ostream& out = outFile.empty() ? cout : file;
+
+        if (!suite) {
+            benchmarkCampusFile(argv[2], argv[2], options, out);
+            return 0;
         }
-        
-        cout << "Path: ";
-        for (int i = 0; i < path.size(); i++) {
-            Location* loc = campus->getLocationById(path[i]);
-            if (loc) {
-                cout << loc->name;
-                if (i < path.size() - 1) {
-                    cout << " -> ";
-                }
+        for (int nodes = 1000; nodes <= maxNodes; nodes *= 10) {
+            for (string kind : {"grid", "geometric", "clustered"}) {
+                string filename = "bench_" + kind + "_" + to_string(nodes) + ".txt";
+                if (!generateCampusFile(kind, nodes, options.seed, filename)) return 1;
+                BenchOptions scaled = options;
+                // Keep the largest graphs to a bounded number of full searches
+                scaled.queries = max(20, min(options.queries, 20000000 / nodes));
+                benchmarkCampusFile(filename, kind, scaled, out);
+                out.flush();
+                remove(filename.c_str());
             }
         }
-        cout << "\n";
+        return 0;
     }
-    
-    void runSimulation(CampusMap* campus, ModifiedDijkstra* pathFinder, int days) {
-        MaintenanceScheduler scheduler(campus, pathFinder);
-        int startDepot = 0;  // Library is the starting point
-        
-        cout << "\n=== Starting Campus Maintenance Simulation for " << days << " days ===\n";
-        campus->printLocationsStatus();
-        
-        for (int day = 0; day < days; day++) {
-            cout << "\n=== Day " << (day + 1) << " ===\n";
-            pair<vector<int>,double> schedulesAndcost = scheduler.generateDailyRoutes(startDepot);
-            vector<int> schedules = schedulesAndcost.first;
-            double cost = schedulesAndcost.second;
-            displayPath(schedules, campus);
-            cout<<"Route Cost -> "<<cost<<'\n';
-            campus->printLocationsStatus();
+
+// Prefer the binary snapshot when it is at least as new as the text backup,
+// and replay the journal written against it. journalBytes is the valid
+// journal length to continue from, 0 if the journal does not apply.
+bool loadCampus(CampusMap& campus, size_t& journalBytes) {
+    journalBytes = 0;
+    error_code ec;
+    auto snapshotTime = filesystem::last_write_time(SNAPSHOT_FILE, ec);
+    if (!ec) {
+        auto backupTime = filesystem::last_write_time(BACKUP_FILE, ec);
+        if ((ec || snapshotTime >= backupTime) && campus.loadSnapshot(SNAPSHOT_FILE)) {
+            journalBytes = CampusJournal::replay(campus, JOURNAL_FILE, CampusMap::snapshotId(SNAPSHOT_FILE));
+            return true;
         }
-    } 
+    }
+    return campus.loadFromFile(BACKUP_FILE);
+}
+
+int main(int argc, char* argv[]) {
+    // Modes that do not use the saved campus
+    string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--generate") return runGenerateCommand(argc, argv);
+    if (mode == "--bench" || mode == "--bench-suite") return runBenchCommand(argc, argv);
 
-int main() {
     CampusMap campus;
-    bool loaded = campus.loadFromFile(BACKUP_FILE);
+    size_t journalBytes;
+    bool loaded = loadCampus(campus, journalBytes);
     if(!loaded){
-        cout<<"Has no backup file. Reseting the campus map."<<endl;
+        // Batch results may be streamed to stdout, so keep it clean there
+        (mode == "--batch" ? cerr : cout)<<"Has no backup file. Reseting the campus map."<<endl;
         campus.loadFromFile(DATA_FILE);
     }
+
+    // Non-interactive modes
+    if (mode == "--sweep" && argc > 2) return runSweepCommand(campus, argc, argv);
+    if (mode == "--batch") return runBatchCommand(campus, argc, argv);
+    if (mode == "--horizon" && argc > 2) return runHorizonCommand(campus, argc, argv);
     int numLocations = campus.getAdjacencyList().size();
 
+    // From here on every change is journaled
+    CampusJournal journal(&campus);
+    journal.start(journalBytes);
+    if (mode == "--serve" && argc > 2) return runServeCommand(campus, journal, argc, argv);
+
     ModifiedDijkstra pathFinder(&campus);
+    ContractionHierarchy hierarchy(&campus);
+    hierarchy.loadFromFile(CH_FILE);
+
+    string dailyStatsFile; // Per-day stats CSV for option 3, set from option 9
 
     bool running = true;
     while (running) {
@@ -457,6 +5076,11 @@ int main() {
         cout << "3. Run simulation for multiple days\n";
         cout << "4. Reset to default configuration\n";
         cout << "5. Exit\n";
+        cout << "6. Compare search algorithms\n";
+        cout << "7. Static distance query (contraction hierarchy)\n";
+        cout << "8. Run multi-crew simulation\n";
+        cout << "9. View routing statistics\n";
+        cout << "10. Update, close, reopen or remove a path\n";
         cout << "Enter your choice: ";
 
         int choice;
@@ -504,7 +5128,7 @@ int main() {
                     break;
                 }
                 
-                runSimulation(&campus, &pathFinder, days);
+                runSimulation(&campus, &pathFinder, days, dailyStatsFile);
                 break;
             }
 
@@ -539,19 +5163,166 @@ int main() {
 
 
                 campus.loadFromFile(BACKUP_FILE);
+                journal.compact();
                 break;
             }
 
             case 5:
                 campus.saveToFile(BACKUP_FILE);
+                journal.compact(); // Fresh snapshot, empty journal
+                hierarchy.saveToFile(CH_FILE);
                 cout<<"All data is saved. Existing Programme.\n";
                 running = false;
                 break;
                 
+            case 6: {
+                int sourceId, destId;
+                cout << "Enter source location ID: ";
+                cin >> sourceId;
+                cout << "Enter destination location ID: ";
+                cin >> destId;
+
+                if (sourceId < 0 || sourceId >= numLocations || destId < 0 || destId >= numLocations) {
+                    cout << "Invalid location ID(s). Please try again.\n";
+                    break;
+                }
+
+                ModifiedDijkstra::SearchMode previous = pathFinder.getSearchMode();
+                vector<pair<string, ModifiedDijkstra::SearchMode>> modes = {
+                    {"Dijkstra", ModifiedDijkstra::SearchMode::Dijkstra},
+                    {"Bidirectional", ModifiedDijkstra::SearchMode::Bidirectional},
+                    {"ALT", ModifiedDijkstra::SearchMode::ALT},
+                    {"Regions", ModifiedDijkstra::SearchMode::Regions}
+                };
+                cout << "\n" << setw(16) << left << "Algorithm" 
+                     << setw(12) << right << "Cost" 
+                     << setw(16) << right << "Settled nodes\n";
+                for (const auto& m : modes) {
+                    pathFinder.setSearchMode(m.second);
+                    pair<vector<int>,double> path_cost = pathFinder.findPath(sourceId, destId);
+                    cout << setw(16) << left << m.first 
+                         << setw(12) << right << fixed << setprecision(2) << path_cost.second 
+                         << setw(15) << right << pathFinder.getSettledCount() << "\n";
+                }
+                pathFinder.setSearchMode(previous);
+                break;
+            }
+
+            case 7: {
+                int sourceId, destId;
+                cout << "Enter source location ID: ";
+                cin >> sourceId;
+                cout << "Enter destination location ID: ";
+                cin >> destId;
+
+                if (sourceId < 0 || sourceId >= numLocations || destId < 0 || destId >= numLocations) {
+                    cout << "Invalid location ID(s). Please try again.\n";
+                    break;
+                }
+
+                pair<vector<int>,double> path_cost = hierarchy.findPath(sourceId, destId);
+                displayPath(path_cost.first, &campus);
+                if (!path_cost.first.empty()) cout << "Static cost -> " << path_cost.second << '\n';
+                break;
+            }
+
+            case 8: {
+                int days, crews;
+                cout << "Enter number of days to simulate: ";
+                cin >> days;
+                if (days <= 0 || days > 30) {
+                    cout << "Invalid number of days. Please enter a value between 1 and 30.\n";
+                    break;
+                }
+                cout << "Enter number of crews: ";
+                cin >> crews;
+                if (crews <= 0 || crews > numLocations) {
+                    cout << "Invalid number of crews.\n";
+                    break;
+                }
+                vector<int> depots;
+                for (int c = 0; c < crews; c++) {
+                    int depot;
+                    cout << "Enter depot location ID for crew " << (c + 1) << ": ";
+                    cin >> depot;
+                    if (depot < 0 || depot >= numLocations) {
+                        cout << "Invalid location ID. Please try again.\n";
+                        break;
+                    }
+                    depots.push_back(depot);
+                }
+                if (depots.size() != crews) break;
+
+                runMultiCrewSimulation(&campus, &pathFinder, days, depots);
+                break;
+            }
+
+            case 9: {
+                if (!ENABLE_STATS) {
+                    cout << "Routing statistics were disabled at build time (ENABLE_STATS=0).\n";
+                    break;
+                }
+                RoutingStats::Totals totals = RoutingStats::snapshot();
+                RoutingStats::print(totals);
+
+                string dumpFile;
+                cout << "Dump to file (.json or .csv, '-' to skip): ";
+                cin >> dumpFile;
+                if (dumpFile != "-") {
+                    ofstream out(dumpFile);
+                    if (!out) {
+                        cerr << "Error: Could not open " << dumpFile << "\n";
+                    } else if (dumpFile.size() >= 4 && dumpFile.compare(dumpFile.size() - 4, 4, ".csv") == 0) {
+                        RoutingStats::writeCsvHeader(out);
+                        RoutingStats::writeCsvRow(out, "total", totals);
+                    } else {
+                        RoutingStats::writeJson(out, totals);
+                    }
+                }
+
+                cout << "Per-day stats CSV for simulations ('-' to disable): ";
+                cin >> dailyStatsFile;
+                if (dailyStatsFile == "-") dailyStatsFile.clear();
+
+                char resetChoice;
+                cout << "Reset counters? (y/n): ";
+                cin >> resetChoice;
+                if (resetChoice == 'y' || resetChoice == 'Y') RoutingStats::reset();
+                break;
+            }
+
+            case 10: {
+                int from, to, action;
+                cout << "Enter path start location ID: ";
+                cin >> from;
+                cout << "Enter path end location ID: ";
+                cin >> to;
+                cout << "1. Set difficulty  2. Close  3. Reopen  4. Remove permanently\n";
+                cout << "Enter action: ";
+                cin >> action;
+
+                bool done = false;
+                if (action == 1) {
+                    double difficulty;
+                    cout << "Enter new difficulty: ";
+                    cin >> difficulty;
+                    done = difficulty >= 0 && campus.updatePathDifficulty(from, to, difficulty);
+                } else if (action == 2) {
+                    done = campus.closePath(from, to);
+                } else if (action == 3) {
+                    done = campus.reopenPath(from, to);
+                } else if (action == 4) {
+                    done = campus.removePath(from, to);
+                }
+                cout << (done ? "Path updated.\n" : "No such path or invalid action.\n");
+                break;
+            }
+
             default:
                 cout << "Invalid choice. Please try again.\n";
                 break;
         }
+        journal.commit(); // The tail of this command's changes
     }
 
     return 0;